@@ -0,0 +1,38 @@
+#ifndef STRKERN_H
+#define STRKERN_H
+
+#include <stddef.h>
+
+/* copy.c 의 copy() 는 한 바이트씩 복사하고 to 가 충분히 크다고 가정한다.
+ * 여기서는 크기를 받는(bounded) 문자열 함수들을 바이트 / 워드(8 바이트) / SSE2 / AVX2 로 구현하고
+ * 처음 부를 때 CPU 에 맞는 것을 고른다.
+ * 벡터 구현은 정렬된 블록 단위로만 읽어서 (두 문자열을 같이 읽는 비교는 페이지 끝에서 바이트로)
+ * 문자열 끝 뒤를 읽더라도 페이지를 넘지 않는다. */
+
+enum { SK_SCALAR, SK_WORD, SK_SSE2, SK_AVX2, SK_LEVELS };
+
+typedef struct {
+	const char *name;
+	size_t (*strnlen)(const char *s, size_t max);
+	const char *(*strnchr)(const char *s, int c, size_t max);
+	int (*strncmp)(const char *a, const char *b, size_t max);
+	size_t (*strlcpy)(char *to, const char *from, size_t size);
+} sk_impl;
+
+/* s 의 길이, 단 max 를 넘지 않는다 */
+size_t sk_strnlen(const char *s, size_t max);
+size_t sk_strlen(const char *s);
+/* s 의 처음 max 바이트 안에서 c 를 찾는다. '\0' 을 먼저 만나거나 없으면 NULL (c 가 0 이면 끝 '\0') */
+const char *sk_strnchr(const char *s, int c, size_t max);
+/* 앞의 max 바이트까지만 비교 (strncmp 와 같다) */
+int sk_strncmp(const char *a, const char *b, size_t max);
+/* from 을 to 에 최대 size - 1 바이트 복사하고 항상 '\0' 으로 끝낸다 (size 가 0 이면 쓰지 않음).
+ * from 의 길이를 돌려주므로 size 이상이면 잘린 것 (BSD strlcpy 와 같다) */
+size_t sk_strlcpy(char *to, const char *from, size_t size);
+
+/* level 의 구현 (이 CPU 에서 못 쓰면 NULL), 지금 고른 level, 강제로 고르기 (못 쓰면 -1) */
+const sk_impl *sk_get_impl(int level);
+int sk_level(void);
+int sk_select(int level);
+
+#endif
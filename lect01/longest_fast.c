@@ -0,0 +1,364 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <immintrin.h>
+
+/* main.c 의 가장 긴 줄 찾기를 큰 입력용으로.
+ * main.c 는 fgets 로 100 바이트씩 읽어서 99 바이트가 넘는 줄은 잘려서 여러 줄로 세고,
+ * 최댓값이 바뀔 때마다 줄 전체를 copy() 한다. 여기서는
+ *   - 줄 길이에 제한이 없고
+ *   - 64 바이트씩 SIMD 로 '\n' 위치를 비트마스크로 얻어 줄 경계를 한 번에 여러 개 찾고
+ *   - 줄을 복사하지 않고 (길이, 시작 오프셋) 만 상위 K 개 힙에 넣고
+ *   - 일반 파일은 mmap 해서 스레드마다 나눠 훑는다.
+ * 파이프로 들어온 stdin 은 큰 버퍼로 읽고, 상위 K 에 들어간 줄만 복사해 둔다.
+ * 길이가 같으면 먼저 나온 줄이 앞선다 (main.c 와 같음). 길이는 '\n' 을 빼고 센다.
+ * 사용법: ./longest_fast [-k 개수(1)] [-t 스레드 수(코어 수)] [-l] [-s] [파일]
+ *   -l : 줄 앞에 "길이<TAB>오프셋<TAB>" 을 붙인다   -s : 처리 속도를 stderr 로 */
+
+#ifndef MADV_POPULATE_READ
+#define MADV_POPULATE_READ 22
+#endif
+
+#define STREAM_CHUNK (4 << 20)
+#define MAX_THREADS 256
+
+typedef struct {
+	size_t len, off;
+	char *copy;                 // 스트림 모드에서만: 줄 내용
+} entry;
+
+/* 상위 K 개를 두는 최소 힙. 맨 위가 K 개 가운데 가장 "약한" 줄 */
+typedef struct {
+	entry *e;
+	int n, k;
+} topk;
+
+/* a 가 b 보다 약하면 참: 짧거나, 길이가 같고 나중에 나온 줄 */
+static int weaker(const entry *a, const entry *b){
+	return a->len < b->len || (a->len == b->len && a->off > b->off);
+}
+
+static void sift_down(topk *t, int i){
+	for(;;){
+		int l = 2 * i + 1, m = i;
+		entry tmp;
+		if(l < t->n && weaker(&t->e[l], &t->e[m])) m = l;
+		if(l + 1 < t->n && weaker(&t->e[l + 1], &t->e[m])) m = l + 1;
+		if(m == i)
+			return;
+		tmp = t->e[i];
+		t->e[i] = t->e[m];
+		t->e[m] = tmp;
+		i = m;
+	}
+}
+
+/* x 가 상위 K 에 들면 넣고 1. 밀려난 줄의 복사본은 해제한다 */
+static int topk_push(topk *t, entry x){
+	if(t->n < t->k){
+		int i = t->n++;
+		t->e[i] = x;
+		while(i > 0 && weaker(&t->e[i], &t->e[(i - 1) / 2])){
+			entry tmp = t->e[i];
+			t->e[i] = t->e[(i - 1) / 2];
+			t->e[(i - 1) / 2] = tmp;
+			i = (i - 1) / 2;
+		}
+		return 1;
+	}
+	if(!weaker(&t->e[0], &x))
+		return 0;
+	free(t->e[0].copy);
+	t->e[0] = x;
+	sift_down(t, 0);
+	return 1;
+}
+
+/* 이보다 길어야 (같으면 먼저 나와야) 들어갈 수 있다. 힙이 덜 찼으면 -1 */
+static long threshold(const topk *t){
+	return t->n < t->k ? -1 : (long)t->e[0].len;
+}
+
+/* ---- '\n' 찾기: 64 바이트마다 비트마스크 ---- */
+
+static uint64_t nl_mask_sse2(const char *p){
+	const __m128i nl = _mm_set1_epi8('\n');
+	uint64_t m0 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), nl));
+	uint64_t m1 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), nl));
+	uint64_t m2 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), nl));
+	uint64_t m3 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), nl));
+	return m0 | m1 << 16 | m2 << 32 | m3 << 48;
+}
+
+__attribute__((target("avx2")))
+static uint64_t nl_mask_avx2(const char *p){
+	const __m256i nl = _mm256_set1_epi8('\n');
+	uint64_t lo = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), nl));
+	uint64_t hi = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + 32)), nl));
+	return lo | hi << 32;
+}
+
+static int use_avx2;
+
+/* 스캔 상태: 지금 줄이 시작한 (입력 전체 기준) 오프셋 */
+typedef struct {
+	size_t line_start;
+	topk top;
+	const char *stream_buf;     // 스트림 모드: 버퍼 시작, 그 버퍼의 입력 오프셋
+	size_t stream_base;
+} scanner;
+
+/* 끝난 줄 [line_start, nl) 하나 */
+static inline void line_end(scanner *s, size_t nl, long *thresh){
+	entry e = { nl - s->line_start, s->line_start, NULL };
+
+	// 힙에 들어갈 줄만 여기까지 온다 (같은 길이는 앞의 것이 이기므로 > 로 충분)
+	if((long)e.len > *thresh){
+		if(s->stream_buf){
+			// 복사하지 못한 줄은 출력할 수 없으므로 realloc 실패와 같이 끝낸다
+			if((e.copy = malloc(e.len + 1)) == NULL){
+				perror("malloc");
+				exit(1);
+			}
+			memcpy(e.copy, s->stream_buf + (e.off - s->stream_base), e.len);
+			e.copy[e.len] = '\0';
+		}
+		topk_push(&s->top, e);
+		*thresh = threshold(&s->top);
+	}
+	s->line_start = nl + 1;
+}
+
+/* [p, p+n) 을 훑는다. base 는 p 의 입력 오프셋 */
+static void scan(scanner *s, const char *p, size_t n, size_t base){
+	long thresh = threshold(&s->top);
+	size_t i = 0;
+
+	if(use_avx2){
+		for(; i + 64 <= n; i += 64){
+			uint64_t m = nl_mask_avx2(p + i);
+			while(m){
+				line_end(s, base + i + __builtin_ctzll(m), &thresh);
+				m &= m - 1;
+			}
+		}
+	} else {
+		for(; i + 64 <= n; i += 64){
+			uint64_t m = nl_mask_sse2(p + i);
+			while(m){
+				line_end(s, base + i + __builtin_ctzll(m), &thresh);
+				m &= m - 1;
+			}
+		}
+	}
+	for(; i < n; i++)
+		if(p[i] == '\n')
+			line_end(s, base + i, &thresh);
+}
+
+/* ---- mmap 한 파일을 스레드로 나눠서 ---- */
+
+typedef struct {
+	const char *data;
+	size_t from, to;            // 이 스레드가 맡은 줄들의 시작 범위 [from, to), to 는 줄 경계
+	scanner s;
+} part;
+
+static void *part_run(void *arg){
+	part *pt = arg;
+	uintptr_t lo = (uintptr_t)(pt->data + pt->from) & ~(uintptr_t)4095, hi = (uintptr_t)(pt->data + pt->to);
+
+	// 페이지 테이블을 한 번에 채워 둔다 (4 KB 마다 폴트를 받는 것보다 빠르다, 5.14+, 실패하면 그냥 폴트)
+	if(hi > lo)
+		madvise((void *)lo, hi - lo, MADV_POPULATE_READ);
+	pt->s.line_start = pt->from;
+	scan(&pt->s, pt->data + pt->from, pt->to - pt->from, pt->from);
+	return NULL;
+}
+
+static int cmp_entry(const void *a, const void *b){
+	return weaker(a, b) ? 1 : weaker(b, a) ? -1 : 0;
+}
+
+static void print_entry(const entry *e, const char *line, int with_len){
+	if(with_len)
+		printf("%zu\t%zu\t", e->len, e->off);
+	fwrite(line, 1, e->len, stdout);
+	putchar('\n');
+}
+
+static void topk_init(topk *t, int k){
+	t->e = calloc(k, sizeof(entry));
+	t->n = 0;
+	t->k = k;
+}
+
+static size_t run_mapped(const char *data, size_t size, int k, int nthreads, int with_len){
+	static part parts[MAX_THREADS];
+	pthread_t tids[MAX_THREADS];
+	int created[MAX_THREADS];
+	topk all;
+
+	if(nthreads < 1)
+		nthreads = 1;
+	if(nthreads > MAX_THREADS)
+		nthreads = MAX_THREADS;
+	if((size_t)nthreads > size / (1 << 20) + 1)
+		nthreads = size / (1 << 20) + 1;    // 1 MB 보다 잘게는 나누지 않는다
+
+	// 경계를 줄 시작으로 옮긴다: 나눈 지점 바로 앞 '\n' 의 다음 바이트
+	for(int i = 0; i < nthreads; i++){
+		size_t at = size / nthreads * i;
+		if(i > 0){
+			const char *nl = at > 0 ? memchr(data + at - 1, '\n', size - at + 1) : data;
+			at = nl ? (size_t)(nl - data) + 1 : size;
+			if(at < parts[i - 1].from)
+				at = parts[i - 1].from;
+		}
+		parts[i].data = data;
+		parts[i].from = at;
+		memset(&parts[i].s, 0, sizeof(scanner));
+		topk_init(&parts[i].s.top, k);
+	}
+	for(int i = 0; i < nthreads; i++)
+		parts[i].to = i + 1 < nthreads ? parts[i + 1].from : size;
+	// 스레드를 못 만들면 그 부분은 여기서 직접
+	for(int i = 1; i < nthreads; i++){
+		created[i] = pthread_create(&tids[i], NULL, part_run, &parts[i]) == 0;
+		if(!created[i])
+			part_run(&parts[i]);
+	}
+	part_run(&parts[0]);
+	for(int i = 1; i < nthreads; i++)
+		if(created[i])
+			pthread_join(tids[i], NULL);
+
+	// 마지막 줄에 '\n' 이 없으면 파일 끝에서 끝난 것으로.
+	// 그 줄이 나눈 지점을 넘으면 뒤쪽 부분들은 비어 있으므로 줄이 시작한 부분에서 닫는다
+	// (다른 부분은 to 가 줄 경계라서 line_start == to 로 끝난다)
+	for(int i = 0; i < nthreads; i++){
+		scanner *sc = &parts[i].s;
+		long thresh = threshold(&sc->top);
+		if(sc->line_start < parts[i].to){
+			line_end(sc, size, &thresh);
+			break;
+		}
+	}
+
+	topk_init(&all, k);
+	for(int i = 0; i < nthreads; i++){
+		for(int j = 0; j < parts[i].s.top.n; j++)
+			topk_push(&all, parts[i].s.top.e[j]);
+		free(parts[i].s.top.e);
+	}
+	qsort(all.e, all.n, sizeof(entry), cmp_entry);
+	for(int i = 0; i < all.n; i++)
+		print_entry(&all.e[i], data + all.e[i].off, with_len);
+	free(all.e);
+	return size;
+}
+
+/* ---- 파이프 stdin: 지금 줄의 시작부터 버퍼에 남겨 두며 읽는다 ---- */
+
+static size_t run_stream(int fd, int k, int with_len){
+	size_t cap = STREAM_CHUNK * 2, have = 0, total = 0;
+	char *buf = malloc(cap);
+	scanner s;
+	ssize_t r;
+
+	if(buf == NULL){
+		perror("malloc");
+		exit(1);
+	}
+	memset(&s, 0, sizeof(s));
+	topk_init(&s.top, k);
+	s.stream_buf = buf;
+	for(;;){
+		// 끝나지 않은 줄은 버퍼 앞으로 옮기고, 줄이 버퍼보다 길면 버퍼를 늘린다
+		size_t keep = total - s.line_start;
+		if(keep > 0 && s.line_start > s.stream_base)
+			memmove(buf, buf + (s.line_start - s.stream_base), keep);
+		s.stream_base = s.line_start;
+		have = keep;
+		if(cap - have < STREAM_CHUNK){
+			cap *= 2;
+			if((buf = realloc(buf, cap)) == NULL){
+				perror("realloc");
+				exit(1);
+			}
+			s.stream_buf = buf;
+		}
+		if((r = read(fd, buf + have, cap - have)) <= 0)
+			break;
+		scan(&s, buf + have, r, total);
+		total += r;
+	}
+	if(s.line_start < total){
+		long thresh = threshold(&s.top);
+		line_end(&s, total, &thresh);
+	}
+	qsort(s.top.e, s.top.n, sizeof(entry), cmp_entry);
+	for(int i = 0; i < s.top.n; i++){
+		print_entry(&s.top.e[i], s.top.e[i].copy, with_len);
+		free(s.top.e[i].copy);
+	}
+	free(s.top.e);
+	free(buf);
+	return total;
+}
+
+int main(int argc, char *argv[]){
+	int k = 1, nthreads = sysconf(_SC_NPROCESSORS_ONLN), with_len = 0, stats = 0, opt, fd = 0;
+	struct timespec t0, t1;
+	struct stat st;
+	size_t bytes;
+	double sec;
+
+	while((opt = getopt(argc, argv, "k:t:ls")) != -1){
+		if(opt == 'k') k = atoi(optarg);
+		else if(opt == 't') nthreads = atoi(optarg);
+		else if(opt == 'l') with_len = 1;
+		else if(opt == 's') stats = 1;
+		else {
+			fprintf(stderr, "Usage : %s [-k count] [-t threads] [-l] [-s] [file]\n", argv[0]);
+			exit(1);
+		}
+	}
+	if(k < 1)
+		k = 1;
+	if(optind < argc && (fd = open(argv[optind], O_RDONLY)) == -1){
+		perror(argv[optind]);
+		exit(1);
+	}
+	__builtin_cpu_init();
+	use_avx2 = __builtin_cpu_supports("avx2");
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+		char *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(data == MAP_FAILED){
+			perror("mmap");
+			exit(1);
+		}
+		madvise(data, st.st_size, MADV_SEQUENTIAL);
+		bytes = run_mapped(data, st.st_size, k, nthreads, with_len);
+		munmap(data, st.st_size);
+	} else {
+		nthreads = 1;
+		bytes = run_stream(fd, k, with_len);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	sec = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+	if(stats)
+		fprintf(stderr, "%zu bytes in %.3f s, %.2f GB/s (%s, %d thread%s)\n", bytes, sec, bytes / sec / 1e9,
+				use_avx2 ? "avx2" : "sse2", nthreads, nthreads > 1 ? "s" : "");
+	return 0;
+}
@@ -0,0 +1,416 @@
+#include <stdint.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+#include "strkern.h"
+
+#define PAGE_SIZE 4096
+#define ONES  0x0101010101010101ULL
+#define LOWS  0x7f7f7f7f7f7f7f7fULL
+#define HIGHS 0x8080808080808080ULL
+
+/* char 배열을 8 바이트씩 읽기 위한 타입 (strict aliasing 예외) */
+typedef uint64_t __attribute__((may_alias)) word_t;
+
+/* addr 부터 len 바이트를 읽으면 페이지를 넘는가 (두 문자열을 같이 읽는 비교에서만 쓴다) */
+static inline int near_page_end(const char *addr, size_t len){
+	return ((uintptr_t)addr & (PAGE_SIZE - 1)) > PAGE_SIZE - len;
+}
+
+static inline size_t min_size(size_t a, size_t b){
+	return a < b ? a : b;
+}
+
+/* 길이를 먼저 재고 한 번에 복사. 잘렸으면 나머지 길이도 재서 from 의 전체 길이를 돌려준다 */
+static inline size_t lcpy(char *to, const char *from, size_t size, size_t (*len)(const char *, size_t)){
+	size_t n;
+
+	if(size == 0)
+		return len(from, SIZE_MAX);
+	n = len(from, size - 1);
+	memcpy(to, from, n);
+	to[n] = '\0';
+	if(n < size - 1)
+		return n;
+	return n + len(from + n, SIZE_MAX);
+}
+
+/* ---- 바이트 단위 (copy() 와 같은 방식, 기준) ---- */
+
+static size_t scalar_strnlen(const char *s, size_t max){
+	size_t i = 0;
+	while(i < max && s[i] != '\0')
+		i++;
+	return i;
+}
+
+static const char *scalar_strnchr(const char *s, int c, size_t max){
+	for(size_t i = 0; i < max; i++){
+		if(s[i] == (char)c)
+			return s + i;
+		if(s[i] == '\0')
+			return NULL;
+	}
+	return NULL;
+}
+
+static int scalar_strncmp(const char *a, const char *b, size_t max){
+	for(size_t i = 0; i < max; i++){
+		unsigned char x = a[i], y = b[i];
+		if(x != y)
+			return x - y;
+		if(x == '\0')
+			return 0;
+	}
+	return 0;
+}
+
+static size_t scalar_strlcpy(char *to, const char *from, size_t size){
+	size_t i = 0;
+
+	if(size > 0){
+		for(; i < size - 1 && from[i] != '\0'; i++)
+			to[i] = from[i];
+		to[i] = '\0';
+	}
+	while(from[i] != '\0')
+		i++;
+	return i;
+}
+
+/* ---- 워드 단위: 8 바이트를 한 번에 보고 '\0' 이 있는 바이트를 비트 연산으로 찾는다 ---- */
+
+/* 0 인 바이트 자리에만 0x80 (다른 바이트에서 올림이 넘어오지 않는 정확한 식) */
+static inline uint64_t zero_bytes(uint64_t v){
+	return ~(((v & LOWS) + LOWS) | v | LOWS);
+}
+
+/* 0 이 아닌 바이트 자리에 0x80 */
+static inline uint64_t nonzero_bytes(uint64_t v){
+	return (((v & LOWS) + LOWS) | v) & HIGHS;
+}
+
+static size_t word_strnlen(const char *s, size_t max){
+	const word_t *w = (const word_t *)((uintptr_t)s & ~(uintptr_t)7);
+	size_t off = (uintptr_t)s & 7, done;
+	uint64_t z;
+
+	// max 가 0 이면 s 가 읽을 수 없는 페이지의 시작일 수도 있으므로 읽기 전에 본다
+	if(max == 0)
+		return 0;
+	// 정렬한 첫 워드에서 s 앞의 바이트는 0 이 아닌 값으로 덮는다
+	z = zero_bytes(*w | ((1ULL << (off * 8)) - 1));
+	for(done = 0; ; done += 8){
+		if(z)
+			return min_size(done + __builtin_ctzll(z) / 8 - off, max);
+		if(done + 8 - off >= max)
+			return max;
+		z = zero_bytes(*++w);
+	}
+}
+
+static const char *word_strnchr(const char *s, int c, size_t max){
+	const word_t *w = (const word_t *)((uintptr_t)s & ~(uintptr_t)7);
+	size_t off = (uintptr_t)s & 7, done;
+	uint64_t cc = ONES * (unsigned char)c, pre = (1ULL << (off * 8)) - 1;
+	uint64_t v, stop;
+
+	if(max == 0)
+		return NULL;
+	v = *w;
+	stop = zero_bytes(v | pre) | zero_bytes((v ^ cc) | pre);
+	for(done = 0; ; done += 8){
+		if(stop){
+			size_t i = done + __builtin_ctzll(stop) / 8 - off;
+			if(i >= max || (s[i] != (char)c))
+				return NULL;        // 범위 밖이거나 '\0' 을 먼저 만남
+			return s + i;
+		}
+		if(done + 8 - off >= max)
+			return NULL;
+		v = *++w;
+		stop = zero_bytes(v) | zero_bytes(v ^ cc);
+	}
+}
+
+static int word_strncmp(const char *a, const char *b, size_t max){
+	size_t i = 0;
+
+	while(i < max){
+		uint64_t x, y, stop;
+		// 두 포인터의 정렬이 다르므로 정렬 읽기를 할 수 없다. 페이지 끝 근처만 바이트로
+		if(near_page_end(a + i, 8) || near_page_end(b + i, 8)){
+			unsigned char p = a[i], q = b[i];
+			if(p != q)
+				return p - q;
+			if(p == '\0')
+				return 0;
+			i++;
+			continue;
+		}
+		memcpy(&x, a + i, 8);
+		memcpy(&y, b + i, 8);
+		if((stop = nonzero_bytes(x ^ y) | zero_bytes(x)) != 0){
+			i += __builtin_ctzll(stop) / 8;
+			return i < max ? (unsigned char)a[i] - (unsigned char)b[i] : 0;
+		}
+		i += 8;
+	}
+	return 0;
+}
+
+static size_t word_strlcpy(char *to, const char *from, size_t size){
+	return lcpy(to, from, size, word_strnlen);
+}
+
+#ifdef __SSE2__
+/* ---- SSE2: 16 바이트 정렬 블록 ---- */
+
+static size_t sse2_strnlen(const char *s, size_t max){
+	const __m128i zero = _mm_setzero_si128();
+	const char *p = (const char *)((uintptr_t)s & ~(uintptr_t)15);
+	size_t off = s - p, done;
+	unsigned m;
+
+	if(max == 0)
+		return 0;
+	m = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), zero)) >> off;
+	if(m)
+		return min_size(__builtin_ctz(m), max);
+	for(done = 16 - off; done < max; done += 16){
+		p += 16;
+		m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), zero));
+		if(m)
+			return min_size(done + __builtin_ctz(m), max);
+	}
+	return max;
+}
+
+static const char *sse2_strnchr(const char *s, int c, size_t max){
+	const __m128i zero = _mm_setzero_si128(), cc = _mm_set1_epi8((char)c);
+	const char *p = (const char *)((uintptr_t)s & ~(uintptr_t)15);
+	size_t off = s - p, done = 0;
+	__m128i v;
+	unsigned m;
+
+	if(max == 0)
+		return NULL;
+	v = _mm_load_si128((const __m128i *)p);
+	m = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, zero), _mm_cmpeq_epi8(v, cc))) >> off;
+	for(;;){
+		if(m){
+			size_t i = done + __builtin_ctz(m);
+			return i < max && s[i] == (char)c ? s + i : NULL;
+		}
+		done = done ? done + 16 : 16 - off;
+		if(done >= max)
+			return NULL;
+		p += 16;
+		v = _mm_load_si128((const __m128i *)p);
+		m = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, zero), _mm_cmpeq_epi8(v, cc)));
+	}
+}
+
+static int sse2_strncmp(const char *a, const char *b, size_t max){
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = 0;
+
+	while(i < max){
+		__m128i x, y;
+		unsigned stop;
+		if(near_page_end(a + i, 16) || near_page_end(b + i, 16)){
+			unsigned char p = a[i], q = b[i];
+			if(p != q)
+				return p - q;
+			if(p == '\0')
+				return 0;
+			i++;
+			continue;
+		}
+		x = _mm_loadu_si128((const __m128i *)(a + i));
+		y = _mm_loadu_si128((const __m128i *)(b + i));
+		stop = (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xffff) | _mm_movemask_epi8(_mm_cmpeq_epi8(x, zero));
+		if(stop){
+			i += __builtin_ctz(stop);
+			return i < max ? (unsigned char)a[i] - (unsigned char)b[i] : 0;
+		}
+		i += 16;
+	}
+	return 0;
+}
+
+static size_t sse2_strlcpy(char *to, const char *from, size_t size){
+	return lcpy(to, from, size, sse2_strnlen);
+}
+
+/* ---- AVX2: 32 바이트 정렬 블록. 긴 문자열은 두 블록씩 ---- */
+
+__attribute__((target("avx2")))
+static size_t avx2_strnlen(const char *s, size_t max){
+	const __m256i zero = _mm256_setzero_si256();
+	const char *p = (const char *)((uintptr_t)s & ~(uintptr_t)31);
+	size_t off = s - p, done;
+	unsigned m;
+
+	if(max == 0)
+		return 0;
+	m = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), zero)) >> off;
+	if(m)
+		return min_size(__builtin_ctz(m), max);
+	done = 32 - off;
+	// 64 바이트 경계까지 한 블록, 그 뒤로는 두 블록을 합쳐 한 번에 검사
+	if(((uintptr_t)p & 32) == 0 && done < max){
+		p += 32;
+		m = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), zero));
+		if(m)
+			return min_size(done + __builtin_ctz(m), max);
+		done += 32;
+	}
+	for(; done < max; done += 64){
+		__m256i v0, v1;
+		uint64_t mm;
+		p += 32;
+		v0 = _mm256_load_si256((const __m256i *)p);
+		v1 = _mm256_load_si256((const __m256i *)(p + 32));
+		p += 32;
+		if(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v0, v1), zero)) == 0)
+			continue;
+		mm = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v0, zero))
+				| (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v1, zero)) << 32;
+		return min_size(done + __builtin_ctzll(mm), max);
+	}
+	return max;
+}
+
+__attribute__((target("avx2")))
+static const char *avx2_strnchr(const char *s, int c, size_t max){
+	const __m256i zero = _mm256_setzero_si256(), cc = _mm256_set1_epi8((char)c);
+	const char *p = (const char *)((uintptr_t)s & ~(uintptr_t)31);
+	size_t off = s - p, done = 0;
+	__m256i v;
+	unsigned m;
+
+	if(max == 0)
+		return NULL;
+	v = _mm256_load_si256((const __m256i *)p);
+	m = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, zero),
+			_mm256_cmpeq_epi8(v, cc))) >> off;
+	for(;;){
+		if(m){
+			size_t i = done + __builtin_ctz(m);
+			return i < max && s[i] == (char)c ? s + i : NULL;
+		}
+		done = done ? done + 32 : 32 - off;
+		if(done >= max)
+			return NULL;
+		p += 32;
+		v = _mm256_load_si256((const __m256i *)p);
+		m = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, zero), _mm256_cmpeq_epi8(v, cc)));
+	}
+}
+
+__attribute__((target("avx2")))
+static int avx2_strncmp(const char *a, const char *b, size_t max){
+	const __m256i zero = _mm256_setzero_si256();
+	size_t i = 0;
+
+	while(i < max){
+		__m256i x, y;
+		unsigned stop;
+		if(near_page_end(a + i, 32) || near_page_end(b + i, 32)){
+			unsigned char p = a[i], q = b[i];
+			if(p != q)
+				return p - q;
+			if(p == '\0')
+				return 0;
+			i++;
+			continue;
+		}
+		x = _mm256_loadu_si256((const __m256i *)(a + i));
+		y = _mm256_loadu_si256((const __m256i *)(b + i));
+		stop = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y))
+				| (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, zero));
+		if(stop){
+			i += __builtin_ctz(stop);
+			return i < max ? (unsigned char)a[i] - (unsigned char)b[i] : 0;
+		}
+		i += 32;
+	}
+	return 0;
+}
+
+static size_t avx2_strlcpy(char *to, const char *from, size_t size){
+	return lcpy(to, from, size, avx2_strnlen);
+}
+#endif
+
+/* ---- 고르기 ---- */
+
+static const sk_impl impls[SK_LEVELS] = {
+	{ "scalar", scalar_strnlen, scalar_strnchr, scalar_strncmp, scalar_strlcpy },
+	{ "word",   word_strnlen,   word_strnchr,   word_strncmp,   word_strlcpy },
+#ifdef __SSE2__
+	{ "sse2",   sse2_strnlen,   sse2_strnchr,   sse2_strncmp,   sse2_strlcpy },
+	{ "avx2",   avx2_strnlen,   avx2_strnchr,   avx2_strncmp,   avx2_strlcpy },
+#endif
+};
+
+static const sk_impl *cur;
+
+static int supported(int level){
+	if(level < 0 || level >= SK_LEVELS || impls[level].name == NULL)
+		return 0;
+#ifdef __SSE2__
+	if(level == SK_AVX2){
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+	}
+#endif
+	return 1;
+}
+
+static const sk_impl *impl(void){
+	if(cur == NULL){
+		int level = SK_LEVELS - 1;
+		while(!supported(level))
+			level--;
+		cur = &impls[level];
+	}
+	return cur;
+}
+
+const sk_impl *sk_get_impl(int level){
+	return supported(level) ? &impls[level] : NULL;
+}
+
+int sk_level(void){
+	return impl() - impls;
+}
+
+int sk_select(int level){
+	if(!supported(level))
+		return -1;
+	cur = &impls[level];
+	return level;
+}
+
+size_t sk_strnlen(const char *s, size_t max){
+	return impl()->strnlen(s, max);
+}
+
+size_t sk_strlen(const char *s){
+	return impl()->strnlen(s, SIZE_MAX);
+}
+
+const char *sk_strnchr(const char *s, int c, size_t max){
+	return impl()->strnchr(s, c, max);
+}
+
+int sk_strncmp(const char *a, const char *b, size_t max){
+	return impl()->strncmp(a, b, max);
+}
+
+size_t sk_strlcpy(char *to, const char *from, size_t size){
+	return impl()->strlcpy(to, from, size);
+}
@@ -0,0 +1,236 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "copy.h"
+#include "strkern.h"
+
+/* strkern.c 의 각 level 을 먼저 검사하고 glibc / copy() 와 속도를 비교한다.
+ * 검사: 시작 정렬 0..63, 길이 0..300, 여러 max 로 바이트 구현 결과와 맞춰 보고,
+ *       문자열을 PROT_NONE 페이지 바로 앞에 두어 끝 뒤를 페이지 너머까지 읽지 않는지 본다.
+ *       하나라도 다르면 종료 코드 1.
+ * 속도: 길이 1 B ~ 1 MB, 시작 정렬 0 과 3 에서 GB/s (처리한 문자열 바이트 기준).
+ * 사용법: ./strkern_bench [-v] [-b 칸마다 훑을 바이트 수(MB, 32)]
+ *   -v : 검사만 */
+
+#define PAGE 4096
+#define MAX_LEN (1 << 20)
+#define CHECK_LEN 300
+
+static int failures;
+
+static double now(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 마지막 페이지를 PROT_NONE 으로 둔 영역. 돌려주는 값은 접근 못 하는 페이지의 시작 */
+static char *guarded(size_t size){
+	size_t len = (size + PAGE - 1) / PAGE * PAGE + PAGE;
+	char *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(p == MAP_FAILED){
+		perror("mmap");
+		exit(1);
+	}
+	mprotect(p + len - PAGE, PAGE, PROT_NONE);
+	return p + len - PAGE;
+}
+
+static int sign(int x){
+	return (x > 0) - (x < 0);
+}
+
+static void fail(const sk_impl *im, const char *what, size_t align, size_t len, size_t max){
+	if(failures++ < 20)
+		fprintf(stderr, "FAIL %s %s: align %zu len %zu max %zu\n", im->name, what, align, len, max);
+}
+
+/* s (길이 len) 하나에 대해 네 함수를 바이트 구현과 맞춰 본다. t 는 s 와 같거나 한 바이트 다른 문자열 */
+static void check_one(const sk_impl *im, const sk_impl *ref, const char *s, const char *t,
+		size_t align, size_t len, char *dst, char *dref){
+	size_t maxes[] = { 0, 1, len / 2, len, len + 1, len + 100, SIZE_MAX };
+	int cs[] = { 'x', 'y', '\0', s[len / 2] };
+
+	for(size_t k = 0; k < sizeof(maxes) / sizeof(maxes[0]); k++){
+		size_t max = maxes[k];
+		if(im->strnlen(s, max) != ref->strnlen(s, max))
+			fail(im, "strnlen", align, len, max);
+		for(size_t j = 0; j < sizeof(cs) / sizeof(cs[0]); j++)
+			if(im->strnchr(s, cs[j], max) != ref->strnchr(s, cs[j], max))
+				fail(im, "strnchr", align, len, max);
+		if(sign(im->strncmp(s, t, max)) != sign(ref->strncmp(s, t, max))
+				|| sign(im->strncmp(t, s, max)) != sign(ref->strncmp(t, s, max)))
+			fail(im, "strncmp", align, len, max);
+		if(max <= len + 1){
+			memset(dst, '#', len + 2);
+			memset(dref, '#', len + 2);
+			if(im->strlcpy(dst, s, max) != ref->strlcpy(dref, s, max) || memcmp(dst, dref, len + 2) != 0)
+				fail(im, "strlcpy", align, len, max);
+		}
+	}
+}
+
+static void verify(const sk_impl *im, const sk_impl *ref){
+	// 페이지 중간에 있는 문자열 (정렬 0..63) 과 PROT_NONE 바로 앞에서 끝나는 문자열
+	static char mid[2 * CHECK_LEN + 256] __attribute__((aligned(64)));
+	static char mid2[2 * CHECK_LEN + 256] __attribute__((aligned(64)));
+	static char dst[CHECK_LEN + 8], dref[CHECK_LEN + 8];
+	char *end = guarded(CHECK_LEN + 1), *end2 = guarded(CHECK_LEN + 1);
+
+	for(size_t len = 0; len <= CHECK_LEN; len++){
+		for(size_t align = 0; align < 64; align++){
+			char *s = mid + align, *t = mid2 + (align * 7) % 64;
+			for(size_t i = 0; i < len; i++)
+				s[i] = t[i] = 'a' + (i * 13 + align) % 26;
+			s[len] = t[len] = '\0';
+			s[len + 1] = t[len + 1] = 'x';      // 끝 뒤의 찌꺼기를 찾으면 안 된다
+			check_one(im, ref, s, t, align, len, dst, dref);
+			if(len > 0){
+				t[(len * 5) % len] ^= 0x80;     // 부호 없는 비교인지도 본다
+				check_one(im, ref, s, t, align, len, dst, dref);
+			}
+		}
+		// '\0' 이 PROT_NONE 페이지 바로 앞. 두 문자열은 페이지 안 위치가 서로 다르다
+		char *s = end - len - 1, *t = end2 - len - 1;
+		memset(s, 'q', len);
+		memset(t, 'q', len);
+		s[len] = t[len] = '\0';
+		check_one(im, ref, s, t, 0, len, dst, dref);
+		if(len > 1){
+			t = end2 - len;                     // t 는 한 바이트 짧게: 페이지 끝에서 다름을 찾는다
+			memset(t, 'q', len - 1);
+			t[len - 1] = '\0';
+			check_one(im, ref, s, t, 1, len, dst, dref);
+		}
+	}
+	// max 가 0 이면 한 바이트도 읽으면 안 된다: 읽을 수 없는 페이지의 시작을 넘긴다
+	if(im->strnlen(end, 0) != 0)
+		fail(im, "strnlen", 0, 0, 0);
+	if(im->strnchr(end, 'q', 0) != NULL || im->strnchr(end, '\0', 0) != NULL)
+		fail(im, "strnchr", 0, 0, 0);
+	if(im->strncmp(end, end2, 0) != 0)
+		fail(im, "strncmp", 0, 0, 0);
+	munmap(end - (CHECK_LEN + 1 + PAGE - 1) / PAGE * PAGE, (CHECK_LEN + 1 + PAGE - 1) / PAGE * PAGE + PAGE);
+	munmap(end2 - (CHECK_LEN + 1 + PAGE - 1) / PAGE * PAGE, (CHECK_LEN + 1 + PAGE - 1) / PAGE * PAGE + PAGE);
+}
+
+/* ---- 속도 ---- */
+
+static volatile size_t sink;
+
+static size_t libc_strnlen(const char *s, size_t max){ return strnlen(s, max); }
+static const char *libc_strchr(const char *s, int c, size_t max){ (void)max; return strchr(s, c); }
+static int libc_strncmp(const char *a, const char *b, size_t max){ return strncmp(a, b, max); }
+static size_t libc_strlcpy(char *to, const char *from, size_t size){
+	size_t n = strnlen(from, size - 1);
+	memcpy(to, from, n);
+	to[n] = '\0';
+	return n;
+}
+static size_t copy_strlcpy(char *to, const char *from, size_t size){
+	(void)size;
+	copy((char *)from, to);
+	return 0;
+}
+
+static const sk_impl libc_impl = { "glibc", libc_strnlen, libc_strchr, libc_strncmp, libc_strlcpy };
+
+enum { OP_LEN, OP_CHR, OP_CMP, OP_CPY, OPS };
+static const char *op_names[OPS] = { "strnlen", "strnchr", "strncmp", "strlcpy" };
+
+/* op 를 길이 len 에 iters 번 돌린 GB/s */
+static double run(const sk_impl *im, int op, const char *s, const char *t, char *dst, size_t len, size_t iters){
+	size_t acc = 0;
+	double t0 = now();
+
+	for(size_t i = 0; i < iters; i++){
+		switch(op){
+		case OP_LEN: acc += im->strnlen(s, len + 1); break;
+		case OP_CHR: acc += (size_t)im->strnchr(s, 'z', len + 1); break;
+		case OP_CMP: acc += im->strncmp(s, t, len + 1); break;
+		case OP_CPY: acc += im->strlcpy(dst, s, len + 1); break;
+		}
+		__asm__ volatile("" ::: "memory");
+	}
+	sink = acc;
+	return (double)len * iters / (now() - t0) / 1e9;
+}
+
+int main(int argc, char *argv[]){
+	static const size_t lens[] = { 1, 8, 64, 512, 4096, 65536, MAX_LEN };
+	static const size_t aligns[] = { 0, 3 };
+	const sk_impl *ref = sk_get_impl(SK_SCALAR), *ims[SK_LEVELS + 2];
+	size_t budget = 32 << 20;
+	int opt, verify_only = 0, n = 0;
+	char *s, *t, *dst;
+
+	while((opt = getopt(argc, argv, "vb:")) != -1){
+		switch(opt){
+		case 'v': verify_only = 1; break;
+		case 'b': budget = (size_t)atol(optarg) << 20; break;
+		default:
+			fprintf(stderr, "Usage : %s [-v] [-b MB]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	for(int level = 0; level < SK_LEVELS; level++){
+		const sk_impl *im = sk_get_impl(level);
+		if(im == NULL){
+			printf("level %d : not supported\n", level);
+			continue;
+		}
+		int before = failures;
+		verify(im, ref);
+		printf("%-7s : %s\n", im->name, failures == before ? "ok" : "FAIL");
+		ims[n++] = im;
+	}
+	printf("dispatch: %s\n", sk_get_impl(sk_level())->name);
+	if(failures)
+		return 1;
+	if(verify_only)
+		return 0;
+
+	ims[n++] = &libc_impl;
+	s = aligned_alloc(64, MAX_LEN + 128);
+	t = aligned_alloc(64, MAX_LEN + 128);
+	dst = aligned_alloc(64, MAX_LEN + 128);
+	memset(s, 'a', MAX_LEN + 128);
+	memset(t, 'a', MAX_LEN + 128);
+	memset(dst, 0, MAX_LEN + 128);
+
+	for(int op = 0; op < OPS; op++){
+		printf("\n%s (GB/s)%s\n%-9s %5s", op_names[op], op == OP_CHR ? "  glibc = strchr" : "", "len", "align");
+		for(int i = 0; i < n; i++)
+			printf(" %8s", ims[i]->name);
+		if(op == OP_CPY)
+			printf(" %8s", "copy()");
+		printf("\n");
+		for(size_t li = 0; li < sizeof(lens) / sizeof(lens[0]); li++){
+			for(size_t ai = 0; ai < sizeof(aligns) / sizeof(aligns[0]); ai++){
+				size_t len = lens[li], iters = budget / len;
+				char *ss = s + aligns[ai], *tt = t + aligns[ai];
+				ss[len] = tt[len] = '\0';
+				ss[len - 1] = tt[len - 1] = 'z';
+				printf("%-9zu %5zu", len, aligns[ai]);
+				for(int i = 0; i < n; i++)
+					printf(" %8.2f", run(ims[i], op, ss, tt, dst, len, iters));
+				if(op == OP_CPY){
+					sk_impl c = { "copy()", NULL, NULL, NULL, copy_strlcpy };
+					printf(" %8.2f", run(&c, op, ss, tt, dst, len, iters));
+				}
+				printf("\n");
+				ss[len] = tt[len] = ss[len - 1] = tt[len - 1] = 'a';
+			}
+		}
+	}
+	free(s);
+	free(t);
+	free(dst);
+	return 0;
+}
@@ -1,12 +1,259 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "calc_vm.h"
+
+/* 사용법: ./calc x op y                  (op: + - x /)
+ *         ./calc -b [-q] [-D 이름=값]... [파일]
+ * -b : 한 줄에 식 하나씩 (calc_vm.h 참고) 읽어서 줄마다 결과나 "error: ..." 를 출력하고
+ *      처리 속도를 stderr 로 알린다. 파일을 주면 (또는 stdin 이 일반 파일이면) mmap 해서 읽는다.
+ *      빈 줄과 '#' 으로 시작하는 줄은 건너뛴다.
+ * -q : 결과를 출력하지 않는다 (계산 속도만)
+ * -D : 변수의 처음 값 */
+
+#define READ_CHUNK (1 << 20)
+#define OUT_SIZE (1 << 16)
+
+typedef struct {
+	cv_env *env;
+	cv_prog prog;
+	int quiet;
+	size_t lines, exprs, errors;
+	char out[OUT_SIZE];
+	size_t out_len;
+} batch;
+
+static double now(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void flush_out(batch *b){
+	fwrite(b->out, 1, b->out_len, stdout);
+	b->out_len = 0;
+}
+
+/* printf 대신 직접 숫자를 쓴다 (줄마다 부르므로) */
+static void put_result(batch *b, int64_t v){
+	char tmp[24];
+	int n = 0;
+	uint64_t u = v < 0 ? -(uint64_t)v : (uint64_t)v;
+
+	if(b->out_len + sizeof(tmp) > OUT_SIZE)
+		flush_out(b);
+	do{
+		tmp[n++] = '0' + u % 10;
+		u /= 10;
+	}while(u);
+	if(v < 0)
+		b->out[b->out_len++] = '-';
+	while(n > 0)
+		b->out[b->out_len++] = tmp[--n];
+	b->out[b->out_len++] = '\n';
+}
+
+static void put_error(batch *b, int err, size_t col){
+	if(b->out_len + 128 > OUT_SIZE)
+		flush_out(b);
+	if(err == CV_EOVERFLOW || err == CV_EDIVZERO)
+		b->out_len += sprintf(b->out + b->out_len, "error: %s\n", cv_strerror(err));
+	else
+		b->out_len += sprintf(b->out + b->out_len, "error: %s at column %zu\n", cv_strerror(err), col + 1);
+}
+
+static void do_line(batch *b, const char *s, size_t len){
+	size_t i = 0, col = 0;
+	int64_t v;
+	int err;
+
+	b->lines++;
+	while(i < len && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r'))
+		i++;
+	if(i == len || s[i] == '#')
+		return;
+	b->exprs++;
+	if((err = cv_compile(b->env, s, len, &b->prog, &col)) == CV_OK)
+		err = cv_eval(&b->prog, b->env, &v);
+	if(err != CV_OK){
+		b->errors++;
+		if(!b->quiet)
+			put_error(b, err, col);
+		if(err == CV_ENOMEM){
+			flush_out(b);
+			exit(1);
+		}
+	}else if(!b->quiet){
+		put_result(b, v);
+	}
+}
+
+/* 끝나지 않은 마지막 줄의 길이를 돌려준다 */
+static size_t do_lines(batch *b, const char *buf, size_t len, int last){
+	const char *p = buf, *end = buf + len, *nl;
+
+	while((nl = memchr(p, '\n', end - p)) != NULL){
+		do_line(b, p, nl - p);
+		p = nl + 1;
+	}
+	if(last && p < end){
+		do_line(b, p, end - p);
+		p = end;
+	}
+	return end - p;
+}
+
+static int run_fd(batch *b, int fd){
+	struct stat st;
+	char *buf;
+	size_t cap = READ_CHUNK, have = 0;
+	ssize_t n;
+
+	if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+		buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+		if(buf != MAP_FAILED){
+			madvise(buf, st.st_size, MADV_SEQUENTIAL);
+			do_lines(b, buf, st.st_size, 1);
+			munmap(buf, st.st_size);
+			return 0;
+		}
+	}
+
+	// 파이프: 큰 버퍼로 읽고 끝나지 않은 줄은 앞으로 옮겨 다음 읽기에 잇는다
+	if((buf = malloc(cap)) == NULL){
+		perror("malloc");
+		return -1;
+	}
+	while((n = read(fd, buf + have, cap - have)) != 0){
+		if(n < 0){
+			perror("read");
+			free(buf);
+			return -1;
+		}
+		have += n;
+		size_t rest = do_lines(b, buf, have, 0);
+		memmove(buf, buf + have - rest, rest);
+		have = rest;
+		if(have == cap){            // 한 줄이 버퍼보다 길다
+			char *nbuf = realloc(buf, cap * 2);
+			if(nbuf == NULL){
+				perror("realloc");
+				free(buf);
+				return -1;
+			}
+			buf = nbuf;
+			cap *= 2;
+		}
+	}
+	do_lines(b, buf, have, 1);
+	free(buf);
+	return 0;
+}
+
+static int batch_main(int argc, char *argv[]){
+	static batch b;
+	int opt, fd = 0, ret;
+	double t0, sec;
+
+	if((b.env = cv_env_create()) == NULL){
+		perror("cv_env_create");
+		return 1;
+	}
+	while((opt = getopt(argc, argv, "bqD:")) != -1){
+		char *eq, *end;
+		long long v;
+		switch(opt){
+		case 'b':
+			break;
+		case 'q':
+			b.quiet = 1;
+			break;
+		case 'D':
+			if((eq = strchr(optarg, '=')) == NULL)
+				goto usage;
+			errno = 0;
+			v = strtoll(eq + 1, &end, 10);
+			if(end == eq + 1 || *end != '\0' || errno == ERANGE || cv_env_set(b.env, optarg, eq - optarg, v) < 0){
+				fprintf(stderr, "bad variable: %s\n", optarg);
+				return 1;
+			}
+			break;
+		default:
+			goto usage;
+		}
+	}
+	if(optind < argc - 1)
+		goto usage;
+	if(optind == argc - 1 && (fd = open(argv[optind], O_RDONLY)) < 0){
+		perror(argv[optind]);
+		return 1;
+	}
+
+	t0 = now();
+	ret = run_fd(&b, fd);
+	sec = now() - t0;
+	flush_out(&b);
+	fprintf(stderr, "%zu expressions (%zu errors) in %.3f s: %.0f expr/s\n",
+			b.exprs, b.errors, sec, sec > 0 ? b.exprs / sec : 0.0);
+	cv_prog_free(&b.prog);
+	cv_env_destroy(b.env);
+	return ret < 0 || b.errors ? 1 : 0;
+
+usage:
+	fprintf(stderr, "Usage : %s -b [-q] [-D name=value]... [file]\n", argv[0]);
+	return 1;
+}
+
+/* 옵션 중에 -b 가 있는지 (-q -b, -qb 처럼 어느 자리에 있어도). "-5" 같은 음수는 옵션이 아니다 */
+static int has_batch_opt(int argc, char *argv[]){
+	for(int i = 1; i < argc; i++){
+		const char *a = argv[i];
+		if(strcmp(a, "--") == 0)
+			break;
+		if(a[0] != '-' || a[1] == '\0' || (a[1] >= '0' && a[1] <= '9'))
+			continue;
+		for(a++; *a; a++){
+			if(*a == 'b')
+				return 1;
+			if(*a == 'D'){          // 값이 붙어 있지 않으면 다음 인자가 값
+				if(a[1] == '\0')
+					i++;
+				break;
+			}
+		}
+	}
+	return 0;
+}
+
+/* x, y 는 정수여야 한다 (옵션을 숫자로 잘못 읽지 않도록) */
+static int is_number(const char *s){
+	if(*s == '-' || *s == '+')
+		s++;
+	return *s >= '0' && *s <= '9';
+}
 
 int main(int argc, char *argv[])
 {
-	char op = argv[2][0];
-	int x = atoi(argv[1]);
-	int y = atoi(argv[3]);
-	
+	char op;
+	int x, y;
+
+	if(has_batch_opt(argc, argv))
+		return batch_main(argc, argv);
+	if(argc != 4 || !is_number(argv[1]) || !is_number(argv[3])){
+		fprintf(stderr, "Usage : %s x op y\n", argv[0]);
+		return 1;
+	}
+	op = argv[2][0];
+	x = atoi(argv[1]);
+	y = atoi(argv[3]);
+
 	switch(op){
 		case '+':
 			printf("%d\n", x + y);
@@ -18,8 +265,15 @@ int main(int argc, char *argv[])
 			printf("%d\n", x * y);
 			break;
 		case '/':
+			if(y == 0){
+				fprintf(stderr, "division by zero\n");
+				return 1;
+			}
 			printf("%d\n", x / y);
 			break;
+		default:
+			fprintf(stderr, "unknown op: %s\n", argv[2]);
+			return 1;
 	}
 
 	return 0;
@@ -0,0 +1,467 @@
+#include <stdlib.h>
+#include <string.h>
+#include "calc_vm.h"
+
+#define NEST_MAX 200            // 괄호, 단항 연산자 중첩 (재귀 깊이)
+
+enum { OP_CONST, OP_VAR, OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_NEG, OP_STORE, OP_HALT };
+
+/* 변수 이름 -> 번호. 값은 번호로 찾는 배열에 따로 두어 VM 에서는 배열만 읽는다 */
+typedef struct {
+	char *name;
+	size_t len;
+	uint32_t slot;
+} var;
+
+struct cv_env {
+	var *tab;                   // 열린 주소법 해시 테이블 (크기는 2 의 거듭제곱)
+	size_t tab_cap, count;
+	int64_t *vals;
+	uint8_t *defined;
+	size_t vals_cap;
+};
+
+typedef struct {
+	const char *src, *p, *end;
+	cv_env *env;
+	cv_prog *prog;
+	int depth, nest, err;
+	const char *errp;
+} compiler;
+
+/* 번역 중의 식 하나. 상수면 값을 같이 들고 있어서 위쪽에서 접을 수 있다 */
+typedef struct {
+	size_t start;               // 이 식의 코드가 시작하는 위치
+	int konst;
+	int64_t v;
+} node;
+
+static inline int is_alpha(int c){
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static inline int is_digit(int c){
+	return c >= '0' && c <= '9';
+}
+
+static uint64_t hash(const char *s, size_t len){
+	uint64_t h = 14695981039346656037ULL;
+	for(size_t i = 0; i < len; i++)
+		h = (h ^ (unsigned char)s[i]) * 1099511628211ULL;
+	return h;
+}
+
+/* ---- 변수 ---- */
+
+cv_env *cv_env_create(void){
+	return calloc(1, sizeof(cv_env));
+}
+
+void cv_env_destroy(cv_env *env){
+	if(env == NULL)
+		return;
+	for(size_t i = 0; i < env->tab_cap; i++)
+		free(env->tab[i].name);
+	free(env->tab);
+	free(env->vals);
+	free(env->defined);
+	free(env);
+}
+
+static var *lookup(const cv_env *env, const char *name, size_t len){
+	if(env->tab_cap == 0)
+		return NULL;
+	for(size_t i = hash(name, len) & (env->tab_cap - 1); ; i = (i + 1) & (env->tab_cap - 1)){
+		var *v = &env->tab[i];
+		if(v->name == NULL)
+			return v;
+		if(v->len == len && memcmp(v->name, name, len) == 0)
+			return v;
+	}
+}
+
+static int grow(cv_env *env){
+	size_t cap = env->tab_cap ? env->tab_cap * 2 : 16;
+	var *old = env->tab, *tab = calloc(cap, sizeof(var));
+
+	if(tab == NULL)
+		return -1;
+	env->tab = tab;
+	env->tab_cap = cap;
+	for(size_t i = 0; i < cap / 2 && old; i++){
+		if(old[i].name)
+			*lookup(env, old[i].name, old[i].len) = old[i];
+	}
+	free(old);
+	return 0;
+}
+
+/* 이름의 번호. 없으면 값이 없는 변수로 만든다. 실패하면 -1 */
+static int64_t intern(cv_env *env, const char *name, size_t len){
+	var *v = lookup(env, name, len);
+
+	if(v && v->name)
+		return v->slot;
+	if(env->count >= UINT32_MAX)
+		return -1;
+	if((env->count + 1) * 2 > env->tab_cap){
+		if(grow(env) < 0)
+			return -1;
+		v = lookup(env, name, len);
+	}
+	if(env->count == env->vals_cap){
+		size_t cap = env->vals_cap ? env->vals_cap * 2 : 16;
+		int64_t *vals = realloc(env->vals, cap * sizeof(int64_t));
+		uint8_t *defined;
+		if(vals == NULL)
+			return -1;
+		env->vals = vals;
+		if((defined = realloc(env->defined, cap)) == NULL)
+			return -1;
+		env->defined = defined;
+		env->vals_cap = cap;
+	}
+	if((v->name = malloc(len)) == NULL)
+		return -1;
+	memcpy(v->name, name, len);
+	v->len = len;
+	v->slot = env->count++;
+	env->vals[v->slot] = 0;
+	env->defined[v->slot] = 0;
+	return v->slot;
+}
+
+int cv_env_set(cv_env *env, const char *name, size_t len, int64_t value){
+	int64_t slot;
+
+	if(len == 0 || !is_alpha(name[0]))
+		return -1;
+	for(size_t i = 1; i < len; i++)
+		if(!is_alpha(name[i]) && !is_digit(name[i]))
+			return -1;
+	if((slot = intern(env, name, len)) < 0)
+		return -1;
+	env->vals[slot] = value;
+	env->defined[slot] = 1;
+	return 0;
+}
+
+/* ---- 번역 ---- */
+
+static void fail(compiler *c, int err, const char *at){
+	if(c->err == CV_OK){
+		c->err = err;
+		c->errp = at;
+	}
+}
+
+static void skip(compiler *c){
+	while(c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\r'))
+		c->p++;
+}
+
+/* 코드 버퍼는 cv_compile 에서 최악의 경우만큼 미리 잡아 두므로 여기서는 넘치지 않는다 */
+static void emit_push(compiler *c, int op, const void *imm, size_t n){
+	cv_prog *pr = c->prog;
+
+	if(++c->depth > CV_STACK_MAX)
+		fail(c, CV_EDEEP, c->p);
+	pr->code[pr->len++] = op;
+	memcpy(pr->code + pr->len, imm, n);
+	pr->len += n;
+}
+
+static void emit_const(compiler *c, int64_t v){
+	emit_push(c, OP_CONST, &v, sizeof(v));
+}
+
+/* 상수 접기와 VM 이 같은 규칙을 쓴다. 오류면 0 이 아닌 값 */
+static int apply(int op, int64_t a, int64_t b, int64_t *r){
+	switch(op){
+	case OP_ADD: return __builtin_add_overflow(a, b, r) ? CV_EOVERFLOW : CV_OK;
+	case OP_SUB: return __builtin_sub_overflow(a, b, r) ? CV_EOVERFLOW : CV_OK;
+	case OP_MUL: return __builtin_mul_overflow(a, b, r) ? CV_EOVERFLOW : CV_OK;
+	case OP_DIV:
+	case OP_MOD:
+		if(b == 0)
+			return CV_EDIVZERO;
+		if(b == -1){            // INT64_MIN / -1 은 넘침, INT64_MIN % -1 은 0
+			if(op == OP_MOD){
+				*r = 0;
+				return CV_OK;
+			}
+			if(a == INT64_MIN)
+				return CV_EOVERFLOW;
+		}
+		*r = op == OP_DIV ? a / b : a % b;
+		return CV_OK;
+	}
+	return CV_ESYNTAX;
+}
+
+static node expr(compiler *c);
+
+static node primary(compiler *c){
+	node n = { c->prog->len, 0, 0 };
+	const char *start;
+
+	skip(c);
+	start = c->p;
+	if(c->p == c->end){
+		fail(c, CV_ESYNTAX, c->p);
+	}else if(is_digit(*c->p)){
+		int64_t v = 0;
+		for(; c->p < c->end && is_digit(*c->p); c->p++){
+			int d = *c->p - '0';
+			if(v > (INT64_MAX - d) / 10){     // 곱하기 전에 본다 (곱한 뒤에는 이미 넘쳐 있을 수 있다)
+				fail(c, CV_EOVERFLOW, start);
+				return n;
+			}
+			v = v * 10 + d;
+		}
+		n.konst = 1;
+		n.v = v;
+		emit_const(c, n.v);
+	}else if(is_alpha(*c->p)){
+		var *v;
+		uint32_t slot;
+		while(c->p < c->end && (is_alpha(*c->p) || is_digit(*c->p)))
+			c->p++;
+		v = lookup(c->env, start, c->p - start);
+		if(v == NULL || v->name == NULL || !c->env->defined[v->slot]){
+			fail(c, CV_EUNDEF, start);
+			return n;
+		}
+		slot = v->slot;
+		emit_push(c, OP_VAR, &slot, sizeof(slot));
+	}else if(*c->p == '('){
+		c->p++;
+		if(++c->nest > NEST_MAX){
+			fail(c, CV_EDEEP, start);
+			return n;
+		}
+		n = expr(c);
+		c->nest--;
+		skip(c);
+		if(c->p == c->end || *c->p != ')')
+			fail(c, CV_ESYNTAX, c->p);
+		else
+			c->p++;
+	}else{
+		fail(c, CV_ESYNTAX, c->p);
+	}
+	return n;
+}
+
+static node unary(compiler *c){
+	node n;
+	int neg = 0;
+
+	// 연달아 붙은 부호는 반복으로 모아서 재귀하지 않는다
+	for(skip(c); c->p < c->end && (*c->p == '-' || *c->p == '+'); skip(c))
+		neg ^= *c->p++ == '-';
+	n = primary(c);
+	if(!neg || c->err)
+		return n;
+	if(n.konst && n.v != INT64_MIN){
+		c->prog->len = n.start;
+		c->depth--;
+		n.v = -n.v;
+		emit_const(c, n.v);
+	}else{
+		c->prog->code[c->prog->len++] = OP_NEG;
+		n.konst = 0;
+	}
+	return n;
+}
+
+/* 왼쪽, 오른쪽 식의 코드가 연달아 있을 때 연산을 붙인다. 둘 다 상수면 하나의 상수로 접는다 */
+static node binary(compiler *c, int op, node a, node b){
+	int64_t r;
+
+	if(a.konst && b.konst && apply(op, a.v, b.v, &r) == CV_OK){
+		c->prog->len = a.start;
+		c->depth -= 2;
+		emit_const(c, r);
+		a.v = r;
+		return a;
+	}
+	c->prog->code[c->prog->len++] = op;
+	c->depth--;
+	a.konst = 0;
+	return a;
+}
+
+static node term(compiler *c){
+	node a = unary(c);
+
+	while(!c->err){
+		int op;
+		skip(c);
+		if(c->p == c->end)
+			break;
+		if(*c->p == '*')
+			op = OP_MUL;
+		else if(*c->p == '/')
+			op = OP_DIV;
+		else if(*c->p == '%')
+			op = OP_MOD;
+		else
+			break;
+		c->p++;
+		a = binary(c, op, a, unary(c));
+	}
+	return a;
+}
+
+static node expr(compiler *c){
+	node a = term(c);
+
+	while(!c->err){
+		int op;
+		skip(c);
+		if(c->p == c->end || (*c->p != '+' && *c->p != '-'))
+			break;
+		op = *c->p++ == '+' ? OP_ADD : OP_SUB;
+		a = binary(c, op, a, term(c));
+	}
+	return a;
+}
+
+int cv_compile(cv_env *env, const char *src, size_t len, cv_prog *prog, size_t *err_off){
+	compiler c = { src, src, src + len, env, prog, 0, 0, CV_OK, NULL };
+	size_t need = len * 9 + 16;     // 한 글자가 상수 하나 (9 바이트) 가 되는 경우가 최악
+	int64_t store = -1;
+
+	if(prog->cap < need){
+		uint8_t *code = realloc(prog->code, need);
+		if(code == NULL)
+			return CV_ENOMEM;
+		prog->code = code;
+		prog->cap = need;
+	}
+	prog->len = 0;
+
+	// "이름 =" 으로 시작하면 대입
+	skip(&c);
+	if(c.p < c.end && is_alpha(*c.p)){
+		const char *name = c.p;
+		while(c.p < c.end && (is_alpha(*c.p) || is_digit(*c.p)))
+			c.p++;
+		size_t n = c.p - name;
+		skip(&c);
+		if(c.p < c.end && *c.p == '='){
+			c.p++;
+			if((store = intern(env, name, n)) < 0)
+				return CV_ENOMEM;
+		}else{
+			c.p = name;
+		}
+	}
+
+	expr(&c);
+	skip(&c);
+	if(c.err == CV_OK && c.p != c.end)
+		fail(&c, CV_ESYNTAX, c.p);
+	if(c.err != CV_OK){
+		if(err_off)
+			*err_off = c.errp - src;
+		prog->len = 0;
+		return c.err;
+	}
+	if(store >= 0){
+		uint32_t slot = store;
+		prog->code[prog->len++] = OP_STORE;
+		memcpy(prog->code + prog->len, &slot, sizeof(slot));
+		prog->len += sizeof(slot);
+	}
+	prog->code[prog->len++] = OP_HALT;
+	return CV_OK;
+}
+
+void cv_prog_free(cv_prog *prog){
+	free(prog->code);
+	prog->code = NULL;
+	prog->len = prog->cap = 0;
+}
+
+/* ---- 실행: 명령마다 다음 명령의 주소로 바로 뛴다 (GCC 의 computed goto) ---- */
+
+int cv_eval(const cv_prog *prog, cv_env *env, int64_t *result){
+	static const void *ops[] = {
+		[OP_CONST] = &&op_const, [OP_VAR] = &&op_var, [OP_ADD] = &&op_add, [OP_SUB] = &&op_sub,
+		[OP_MUL] = &&op_mul, [OP_DIV] = &&op_div, [OP_MOD] = &&op_mod, [OP_NEG] = &&op_neg,
+		[OP_STORE] = &&op_store, [OP_HALT] = &&op_halt,
+	};
+	int64_t stack[CV_STACK_MAX], *sp = stack;     // sp 는 다음 빈 칸
+	const uint8_t *pc = prog->code;
+	uint32_t slot;
+	int err;
+
+	if(prog->len == 0)
+		return CV_ESYNTAX;
+#define NEXT goto *ops[*pc++]
+	NEXT;
+op_const:
+	memcpy(sp++, pc, sizeof(int64_t));
+	pc += sizeof(int64_t);
+	NEXT;
+op_var:
+	memcpy(&slot, pc, sizeof(slot));
+	pc += sizeof(slot);
+	*sp++ = env->vals[slot];
+	NEXT;
+op_add:
+	sp--;
+	if(__builtin_add_overflow(sp[-1], sp[0], &sp[-1]))
+		return CV_EOVERFLOW;
+	NEXT;
+op_sub:
+	sp--;
+	if(__builtin_sub_overflow(sp[-1], sp[0], &sp[-1]))
+		return CV_EOVERFLOW;
+	NEXT;
+op_mul:
+	sp--;
+	if(__builtin_mul_overflow(sp[-1], sp[0], &sp[-1]))
+		return CV_EOVERFLOW;
+	NEXT;
+op_div:
+	sp--;
+	if((err = apply(OP_DIV, sp[-1], sp[0], &sp[-1])) != CV_OK)
+		return err;
+	NEXT;
+op_mod:
+	sp--;
+	if((err = apply(OP_MOD, sp[-1], sp[0], &sp[-1])) != CV_OK)
+		return err;
+	NEXT;
+op_neg:
+	if(sp[-1] == INT64_MIN)
+		return CV_EOVERFLOW;
+	sp[-1] = -sp[-1];
+	NEXT;
+op_store:
+	memcpy(&slot, pc, sizeof(slot));
+	pc += sizeof(slot);
+	env->vals[slot] = sp[-1];
+	env->defined[slot] = 1;
+	NEXT;
+op_halt:
+	*result = sp[-1];
+	return CV_OK;
+#undef NEXT
+}
+
+const char *cv_strerror(int err){
+	switch(err){
+	case CV_OK: return "ok";
+	case CV_ESYNTAX: return "syntax error";
+	case CV_EUNDEF: return "undefined variable";
+	case CV_EDEEP: return "expression too deep";
+	case CV_ENOMEM: return "out of memory";
+	case CV_EOVERFLOW: return "overflow";
+	case CV_EDIVZERO: return "division by zero";
+	}
+	return "unknown error";
+}
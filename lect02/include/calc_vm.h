@@ -0,0 +1,39 @@
+#ifndef CALC_VM_H
+#define CALC_VM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* calc.c 의 "x op y" 하나 대신 식 한 줄을 바이트코드로 번역해 두고 스택 VM 으로 계산한다.
+ *   식   : 정수, 변수, + - * / %, 단항 -, 괄호 (보통의 우선순위, 왼쪽 결합)
+ *   대입 : "이름 = 식" 은 계산한 값을 변수에 넣고 그 값을 돌려준다
+ * 상수끼리의 연산은 번역할 때 미리 계산해 둔다 (넘침이나 0 나누기가 되는 것은 실행 때 오류로 남긴다).
+ * 값은 64 비트 부호 있는 정수이고 넘침, 0 으로 나누기를 오류로 돌려준다.
+ * 변수는 번역할 때 이미 값이 있어야 한다 (-D 로 주거나 앞 줄에서 대입). */
+
+enum { CV_OK, CV_ESYNTAX, CV_EUNDEF, CV_EDEEP, CV_ENOMEM, CV_EOVERFLOW, CV_EDIVZERO };
+
+#define CV_STACK_MAX 256        // 실행 스택 깊이 (번역할 때 넘으면 CV_EDEEP)
+
+typedef struct cv_env cv_env;
+
+/* 번역한 식. 같은 cv_prog 를 다음 번역에 다시 쓰면 메모리를 새로 잡지 않는다 */
+typedef struct {
+	uint8_t *code;
+	size_t len, cap;
+} cv_prog;
+
+cv_env *cv_env_create(void);
+void cv_env_destroy(cv_env *env);
+/* 변수에 값을 넣는다 (없으면 만든다). 이름이 잘못됐거나 메모리가 없으면 -1 */
+int cv_env_set(cv_env *env, const char *name, size_t len, int64_t value);
+
+/* src 의 len 바이트를 번역한다. 실패하면 오류 코드와 함께 *err_off 에 문제가 된 위치 */
+int cv_compile(cv_env *env, const char *src, size_t len, cv_prog *prog, size_t *err_off);
+/* 계산해서 *result 에. 대입이 있으면 env 의 변수도 바꾼다 */
+int cv_eval(const cv_prog *prog, cv_env *env, int64_t *result);
+void cv_prog_free(cv_prog *prog);
+
+const char *cv_strerror(int err);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef REAPER_H
+#define REAPER_H
+
+#include <sys/types.h>
+#include <sys/resource.h>
+
+/* waitpid.c 의 WNOHANG + sleep(1) 폴링이나 wait.c 의 블로킹 wait() 대신,
+ * 자식마다 pidfd_open 으로 얻은 fd 를 epoll 에 올려 두고 끝나는 즉시 거둔다.
+ * pidfd 를 못 쓰면 (커널 5.3 미만, fd 부족) SIGCHLD 를 signalfd 로 받아 wait4(-1) 로 거둔다.
+ * 거둘 때 wait4 로 자식의 rusage (CPU 시간, 최대 RSS, 폴트) 도 함께 받는다.
+ *
+ * reaper_create 는 호출한 스레드에서 SIGCHLD 를 막는다 (signalfd 로 받기 위해).
+ * 다른 스레드에서 SIGCHLD 를 처리하거나 SIG_IGN 으로 두면 안 된다.
+ * pidfd 는 CLOEXEC 이지만 fork 는 fd 테이블을 그대로 복사하므로, 추적 중인 자식이 많을 때
+ * fork 한 자식은 exec 하거나 끝날 때까지 그 pidfd 들을 모두 들고 있다. */
+
+typedef struct {
+	pid_t pid;
+	int status;                 // waitpid 의 status 형식
+	struct rusage ru;
+	void *ctx;                  // reaper_add 때 넘긴 값 (추적하지 않던 자식이면 NULL)
+} reaper_exit;
+
+typedef struct reaper reaper;
+
+/* use_pidfd 가 0 이면 처음부터 signalfd 방식만 쓴다 */
+reaper *reaper_create(int use_pidfd);
+void reaper_destroy(reaper *r);
+
+/* 자식 pid 를 추적 목록에 넣는다. 성공 0, 실패 -1 */
+int reaper_add(reaper *r, pid_t pid, void *ctx);
+
+/* 끝난 자식을 최대 max 개까지 out 에 담아 돌려준다.
+ * 하나도 없으면 timeout_ms 동안 기다린다 (-1 이면 무한). 오류면 -1 */
+int reaper_poll(reaper *r, reaper_exit *out, int max, int timeout_ms);
+
+/* 다른 epoll 루프에 끼워 넣을 때 쓰는 fd (읽을 수 있으면 reaper_poll(.., 0) 을 부른다) */
+int reaper_fd(const reaper *r);
+/* 아직 거두지 않은 추적 중인 자식 수 */
+int reaper_count(const reaper *r);
+/* pidfd 없이 signalfd 로 추적 중인 자식 수 */
+int reaper_fallback_count(const reaper *r);
+
+#endif
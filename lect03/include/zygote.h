@@ -0,0 +1,34 @@
+#ifndef ZYGOTE_H
+#define ZYGOTE_H
+
+#include <sys/types.h>
+
+/* 미리 fork 해 둔 작은 도우미 프로세스(zygote)가 요청을 받아 자식을 대신 만든다.
+ * fork 비용은 부모의 RSS(페이지 테이블 복사)에 비례하므로, 부모가 커지기 전에
+ * zygote_start 를 불러 두면 부모가 몇 GB 가 되어도 생성 지연이 일정하다.
+ * 자식은 zygote 의 자식이므로 부모는 waitpid 대신 zygote_wait 로 종료를 받는다. */
+
+#define ZYG_MSG_MAX 65536       // 요청 하나(경로 + 인자)의 최대 크기
+
+typedef struct {
+	pid_t pid;
+	int status;                 // waitpid 의 status 형식
+} zyg_exit;
+
+typedef struct {
+	int sock;                   // SOCK_SEQPACKET, 메시지 하나 = 요청/응답 하나
+	pid_t pid;                  // zygote 프로세스
+	zyg_exit *pending;          // spawn 응답을 기다리는 동안 먼저 도착한 종료 통지
+	int npending, cap;
+} zygote;
+
+/* zygote 프로세스를 띄운다. 성공 0, 실패 -1 */
+int zygote_start(zygote *z);
+/* path 를 argv 로 실행하는 자식을 만들고 pid 를 돌려준다. 실패하면 -1 (errno 설정) */
+pid_t zygote_spawn(zygote *z, const char *path, char *const argv[]);
+/* 자식 하나가 끝날 때까지 기다린다. 성공 0, zygote 가 사라졌으면 -1 */
+int zygote_wait(zygote *z, pid_t *pid, int *status);
+/* 연결을 끊고 zygote 를 거둔다 (남은 자식은 zygote 가 끝까지 reap 한 뒤 종료) */
+void zygote_stop(zygote *z);
+
+#endif
@@ -0,0 +1,235 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "reaper.h"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+#define SIGFD_KEY UINT64_MAX       // epoll data: signalfd 는 이 값, pidfd 는 pid
+
+typedef struct node {
+	pid_t pid;
+	int pidfd;                  // -1 이면 signalfd 로 추적
+	void *ctx;
+	struct node *next;
+} node;
+
+struct reaper {
+	int epfd, sigfd;
+	int use_pidfd;
+	node **buckets;             // pid -> node (체이닝)
+	unsigned nbuckets;
+	int count, nfallback;
+	int rescan;                 // signalfd 없이도 wait4(-1) 를 한 번 더 돌려야 함
+};
+
+static unsigned hash_pid(const reaper *r, pid_t pid){
+	return ((unsigned)pid * 2654435761u) & (r->nbuckets - 1);
+}
+
+static node *take(reaper *r, pid_t pid){
+	node **pp = &r->buckets[hash_pid(r, pid)];
+
+	for(; *pp; pp = &(*pp)->next){
+		if((*pp)->pid == pid){
+			node *n = *pp;
+			*pp = n->next;
+			return n;
+		}
+	}
+	return NULL;
+}
+
+static int contains(const reaper *r, pid_t pid){
+	for(node *n = r->buckets[hash_pid(r, pid)]; n; n = n->next)
+		if(n->pid == pid)
+			return 1;
+	return 0;
+}
+
+static void grow(reaper *r){
+	unsigned old = r->nbuckets;
+	node **ob = r->buckets;
+
+	r->nbuckets = old * 2;
+	r->buckets = calloc(r->nbuckets, sizeof(node *));
+	for(unsigned i = 0; i < old; i++){
+		for(node *n = ob[i], *next; n; n = next){
+			unsigned h = hash_pid(r, n->pid);
+			next = n->next;
+			n->next = r->buckets[h];
+			r->buckets[h] = n;
+		}
+	}
+	free(ob);
+}
+
+reaper *reaper_create(int use_pidfd){
+	reaper *r = calloc(1, sizeof(*r));
+	struct epoll_event ev = { .events = EPOLLIN, .data.u64 = SIGFD_KEY };
+	sigset_t mask;
+
+	if(r == NULL)
+		return NULL;
+	r->use_pidfd = use_pidfd;
+	r->nbuckets = 1024;
+	r->buckets = calloc(r->nbuckets, sizeof(node *));
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	pthread_sigmask(SIG_BLOCK, &mask, NULL);
+	r->sigfd = signalfd(-1, &mask, SFD_NONBLOCK|SFD_CLOEXEC);
+	r->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if(r->buckets == NULL || r->sigfd == -1 || r->epfd == -1 ||
+			epoll_ctl(r->epfd, EPOLL_CTL_ADD, r->sigfd, &ev) == -1){
+		reaper_destroy(r);
+		return NULL;
+	}
+	return r;
+}
+
+void reaper_destroy(reaper *r){
+	if(r == NULL)
+		return;
+	for(unsigned i = 0; r->buckets && i < r->nbuckets; i++){
+		for(node *n = r->buckets[i], *next; n; n = next){
+			next = n->next;
+			if(n->pidfd >= 0)
+				close(n->pidfd);
+			free(n);
+		}
+	}
+	free(r->buckets);
+	if(r->epfd >= 0) close(r->epfd);
+	if(r->sigfd >= 0) close(r->sigfd);
+	free(r);
+}
+
+int reaper_add(reaper *r, pid_t pid, void *ctx){
+	node *n = malloc(sizeof(*n));
+	unsigned h;
+
+	if(n == NULL)
+		return -1;
+	n->pid = pid;
+	n->ctx = ctx;
+	n->pidfd = -1;
+	if(r->use_pidfd){
+		n->pidfd = syscall(SYS_pidfd_open, pid, 0);
+		if(n->pidfd >= 0){
+			struct epoll_event ev = { .events = EPOLLIN, .data.u64 = (uint64_t)pid };
+			if(epoll_ctl(r->epfd, EPOLL_CTL_ADD, n->pidfd, &ev) == -1){
+				close(n->pidfd);
+				n->pidfd = -1;
+			}
+		} else if(errno == ENOSYS){
+			r->use_pidfd = 0;   // 커널이 지원하지 않으면 이후로는 시도하지 않는다
+		}
+	}
+	// pidfd 가 없으면 SIGCHLD 로 추적. 이미 끝나서 SIGCHLD 를 버렸을 수 있으므로 다음 poll 에서 한 번 훑는다
+	if(n->pidfd < 0){
+		r->nfallback++;
+		r->rescan = 1;
+	}
+
+	if((unsigned)r->count >= r->nbuckets)
+		grow(r);
+	h = hash_pid(r, pid);
+	n->next = r->buckets[h];
+	r->buckets[h] = n;
+	r->count++;
+	return 0;
+}
+
+/* pid 하나를 거두어 out 에 채운다. 아직 살아 있으면 0, 거두었으면 1 */
+static int reap_pid(reaper *r, pid_t pid, reaper_exit *out){
+	node *n;
+	pid_t got;
+
+	do{
+		got = wait4(pid, &out->status, WNOHANG, &out->ru);
+	}while(got == -1 && errno == EINTR);
+	if(got <= 0)
+		return 0;
+	out->pid = got;
+	out->ctx = NULL;
+	if((n = take(r, got)) != NULL){
+		out->ctx = n->ctx;
+		if(n->pidfd >= 0)
+			close(n->pidfd);    // close 하면 epoll 에서도 빠진다
+		else
+			r->nfallback--;
+		free(n);
+		r->count--;
+	}
+	return 1;
+}
+
+int reaper_poll(reaper *r, reaper_exit *out, int max, int timeout_ms){
+	struct epoll_event evs[256];
+	int got = 0;
+
+	// 지난번에 max 에 걸려 멈췄거나 새 fallback 자식이 있으면 먼저 훑는다
+	if(r->rescan){
+		while(got < max && reap_pid(r, -1, &out[got]))
+			got++;
+		r->rescan = got == max;
+		if(got > 0)
+			return got;
+	}
+	while(got == 0){
+		int nev = epoll_wait(r->epfd, evs, max < 256 ? max : 256, timeout_ms);
+
+		if(nev == -1){
+			if(errno == EINTR) continue;
+			return -1;
+		}
+		if(nev == 0)
+			return 0;
+		for(int i = 0; i < nev && got < max; i++){
+			if(evs[i].data.u64 == SIGFD_KEY){
+				struct signalfd_siginfo si;
+				while(read(r->sigfd, &si, sizeof(si)) == sizeof(si))
+					;
+				// pidfd 로 추적하는 자식만 있으면 SIGCHLD 는 버린다 (pidfd 쪽에서 거둔다)
+				if(r->nfallback == 0)
+					continue;
+				// SIGCHLD 는 합쳐질 수 있으므로 끝난 자식이 없을 때까지 거둔다
+				while(got < max && reap_pid(r, -1, &out[got]))
+					got++;
+				if(got == max)
+					r->rescan = 1;
+			} else {
+				pid_t pid = (pid_t)evs[i].data.u64;
+				// 같은 배치에서 signalfd 쪽이 이미 거두었을 수 있다
+				if(contains(r, pid) && reap_pid(r, pid, &out[got]))
+					got++;
+			}
+		}
+	}
+	return got;
+}
+
+int reaper_fd(const reaper *r){
+	return r->epfd;
+}
+
+int reaper_count(const reaper *r){
+	return r->count;
+}
+
+int reaper_fallback_count(const reaper *r){
+	return r->nfallback;
+}
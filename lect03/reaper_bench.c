@@ -0,0 +1,146 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "reaper.h"
+
+/* 자식 N 개를 만들어 두고 한꺼번에 끝나게 한 뒤, 거두는 방식별로
+ * 출발 신호부터 각 자식을 거둘 때까지의 시간(p50/p99/최대)과 부모가 쓴 CPU 시간을 잰다.
+ *   pidfd    : reaper (pidfd + epoll)
+ *   signalfd : reaper (SIGCHLD + signalfd, pidfd 없이)
+ *   wait     : wait.c 처럼 블로킹 wait4(-1)
+ *   poll     : waitpid.c 처럼 WNOHANG 폴링 (sleep(1) 대신 1 ms)
+ * 사용법: ./reaper_bench [자식 수(10000)] */
+
+enum { M_PIDFD, M_SIGNALFD, M_WAIT, M_POLL, M_COUNT };
+static const char *mode_name[] = { "pidfd", "signalfd", "wait", "poll" };
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double cpu_sec(void){
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+static int cmp_double(const void *a, const void *b){
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+static void run(int mode, int nchild){
+	reaper *r = NULL;
+	reaper_exit ex[256];
+	double *lat = malloc(sizeof(double) * nchild), t_go, cpu0, child_cpu = 0;
+	long maxrss = 0, minflt = 0;
+	int go[2], reaped = 0, spawned = 0, bad_status = 0;
+	pid_t *pids = malloc(sizeof(pid_t) * nchild);
+
+	if(mode == M_PIDFD || mode == M_SIGNALFD){
+		if((r = reaper_create(mode == M_PIDFD)) == NULL){
+			perror("reaper_create");
+			exit(1);
+		}
+	}
+	pipe(go);
+	for(int i = 0; i < nchild; i++){
+		pid_t pid = fork();
+		char c;
+		if(pid == -1){
+			perror("fork");
+			break;
+		}
+		if(pid == 0){
+			// 출발 신호(쓰기 끝이 닫혀 EOF)를 기다렸다가 바로 끝난다
+			close(go[1]);
+			read(go[0], &c, 1);
+			_exit(i & 0x7f);
+		}
+		pids[spawned++] = pid;
+	}
+	close(go[0]);
+	// 다 만든 뒤에 등록한다. 등록하면서 fork 하면 자식마다 그때까지의 pidfd 를 물려받아
+	// 끝날 때 닫느라 느려진다 (reaper.h 참고)
+	for(int i = 0; r && i < spawned; i++)
+		reaper_add(r, pids[i], (void *)(long)(i & 0x7f));
+
+	cpu0 = cpu_sec();
+	t_go = now_sec();
+	close(go[1]);
+
+	while(reaped < spawned){
+		int n = 0;
+
+		switch(mode){
+		case M_PIDFD:
+		case M_SIGNALFD:
+			n = reaper_poll(r, ex, 256, -1);
+			for(int i = 0; i < n; i++)
+				if(!WIFEXITED(ex[i].status) || WEXITSTATUS(ex[i].status) != (long)ex[i].ctx)
+					bad_status++;
+			break;
+		case M_WAIT:
+			ex[0].pid = wait4(-1, &ex[0].status, 0, &ex[0].ru);
+			n = ex[0].pid > 0;
+			break;
+		case M_POLL:
+			while(n < 256 && (ex[n].pid = wait4(-1, &ex[n].status, WNOHANG, &ex[n].ru)) > 0)
+				n++;
+			if(n == 0)
+				usleep(1000);
+			break;
+		}
+		if(n < 0)
+			break;
+		for(int i = 0; i < n; i++){
+			struct rusage *ru = &ex[i].ru;
+			lat[reaped++] = now_sec() - t_go;
+			child_cpu += ru->ru_utime.tv_sec + ru->ru_utime.tv_usec / 1e6 + ru->ru_stime.tv_sec + ru->ru_stime.tv_usec / 1e6;
+			if(ru->ru_maxrss > maxrss)
+				maxrss = ru->ru_maxrss;
+			minflt += ru->ru_minflt;
+		}
+	}
+
+	qsort(lat, reaped, sizeof(double), cmp_double);
+	printf("%-9s %7d %9.1f %9.1f %9.1f %10.1f %10.1f %8ld %9.1f %s\n", mode_name[mode], reaped,
+			lat[reaped / 2] * 1e3, lat[(long)reaped * 99 / 100] * 1e3, lat[reaped - 1] * 1e3,
+			(cpu_sec() - cpu0) * 1e3, child_cpu * 1e3, maxrss, (double)minflt / reaped,
+			bad_status ? "BAD STATUS" : "");
+	fflush(stdout);
+	if(r)
+		reaper_destroy(r);
+	free(lat);
+	free(pids);
+}
+
+int main(int argc, char *argv[]){
+	int nchild = 10000;
+	struct rlimit rl;
+
+	if(argc > 1) nchild = atoi(argv[1]);
+	if(nchild < 1){
+		fprintf(stderr, "Usage : %s [children]\n", argv[0]);
+		exit(1);
+	}
+	// pidfd 를 자식 수만큼 열어야 한다
+	if(getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max){
+		rl.rlim_cur = rl.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &rl);
+	}
+
+	printf("%-9s %7s %9s %9s %9s %10s %10s %8s %9s\n", "mode", "reaped", "p50_ms", "p99_ms", "max_ms",
+			"parent_ms", "child_ms", "maxrssKB", "minflt");
+	for(int m = 0; m < M_COUNT; m++)
+		run(m, nchild);
+	return 0;
+}
@@ -0,0 +1,169 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sched.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "zygote.h"
+
+/* exec1.c / fork1~3.c 처럼 자식을 만들어 /bin/true 를 실행하되, 생성 방식과 부모 RSS 를 바꿔 가며
+ * 초당 생성 수와 생성 호출 지연을 잰다.
+ *   fork+exec, vfork+exec, posix_spawn, clone(CLONE_VM|CLONE_VFORK)+exec, zygote
+ * zygote 는 부모가 커지기 전에 띄워 두므로 부모 RSS 와 무관해야 한다.
+ * 사용 가능한 메모리의 80% 를 넘는 RSS 는 건너뛴다.
+ * 사용법: ./spawn_bench [반복 수(200)] [최대 RSS MB(10240)] */
+
+extern char **environ;
+
+static char *child_argv[] = { "true", NULL };
+static const char *child_path = "/bin/true";
+
+enum { S_FORK, S_VFORK, S_SPAWN, S_CLONE, S_ZYGOTE, S_COUNT };
+static const char *method_name[] = { "fork+exec", "vfork+exec", "posix_spawn", "clone_vfork", "zygote" };
+
+static zygote zyg;
+static char *clone_stack;
+#define CLONE_STACK_SIZE (64 * 1024)
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int clone_child(void *arg){
+	(void)arg;
+	execv(child_path, child_argv);
+	_exit(127);
+}
+
+static pid_t spawn_one(int method){
+	pid_t pid = -1;
+
+	switch(method){
+	case S_FORK:
+		if((pid = fork()) == 0){
+			execv(child_path, child_argv);
+			_exit(127);
+		}
+		break;
+	case S_VFORK:
+		if((pid = vfork()) == 0){
+			execv(child_path, child_argv);
+			_exit(127);
+		}
+		break;
+	case S_SPAWN:
+		if(posix_spawn(&pid, child_path, NULL, NULL, child_argv, environ) != 0)
+			pid = -1;
+		break;
+	case S_CLONE:
+		// 주소 공간을 공유하므로 자식은 별도 스택에서 exec 까지만 간다. 부모는 exec 될 때까지 멈춘다
+		pid = clone(clone_child, clone_stack + CLONE_STACK_SIZE, CLONE_VM|CLONE_VFORK|SIGCHLD, NULL);
+		break;
+	case S_ZYGOTE:
+		pid = zygote_spawn(&zyg, child_path, child_argv);
+		break;
+	}
+	return pid;
+}
+
+static void reap_one(int method, pid_t pid){
+	int status;
+
+	if(method == S_ZYGOTE)
+		zygote_wait(&zyg, &pid, &status);
+	else
+		waitpid(pid, &status, 0);
+}
+
+static long mem_available_mb(void){
+	FILE *fp = fopen("/proc/meminfo", "r");
+	char line[256];
+	long kb = -1;
+
+	if(fp == NULL)
+		return -1;
+	while(fgets(line, sizeof(line), fp))
+		if(sscanf(line, "MemAvailable: %ld", &kb) == 1)
+			break;
+	fclose(fp);
+	return kb < 0 ? -1 : kb / 1024;
+}
+
+int main(int argc, char *argv[]){
+	int iters = 200;
+	long max_mb = 10240, avail, have_mb = 0;
+	char *ballast = NULL;
+	static const long rss_mb[] = { 10, 100, 1024, 10240 };
+
+	if(argc > 1) iters = atoi(argv[1]);
+	if(argc > 2) max_mb = atol(argv[2]);
+	if(iters < 1){
+		fprintf(stderr, "Usage : %s [iterations] [max_rss_MB]\n", argv[0]);
+		exit(1);
+	}
+	// 부모가 작을 때 zygote 를 먼저 띄운다
+	if(zygote_start(&zyg) == -1){
+		perror("zygote_start");
+		exit(1);
+	}
+	clone_stack = malloc(CLONE_STACK_SIZE);
+	avail = mem_available_mb();
+
+	printf("%-8s", "RSS_MB");
+	for(int m = 0; m < S_COUNT; m++)
+		printf(" %20s", method_name[m]);
+	printf("   (spawns/s, us per spawn call)\n");
+
+	for(unsigned r = 0; r < sizeof(rss_mb) / sizeof(rss_mb[0]) && rss_mb[r] <= max_mb; r++){
+		long mb = rss_mb[r];
+
+		if(avail > 0 && mb > avail * 8 / 10){
+			printf("%-8ld skipped (only %ld MB available)\n", mb, avail);
+			break;
+		}
+		// 부모 RSS 를 mb 까지 키운다 (이전 매핑은 버리고 새로 채움)
+		if(ballast)
+			munmap(ballast, (size_t)have_mb << 20);
+		ballast = mmap(NULL, (size_t)mb << 20, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+		if(ballast == MAP_FAILED){
+			perror("mmap");
+			break;
+		}
+		memset(ballast, 1, (size_t)mb << 20);
+		have_mb = mb;
+
+		printf("%-8ld", mb);
+		for(int m = 0; m < S_COUNT; m++){
+			double call = 0, t0 = now_sec(), t1;
+			int fails = 0;
+
+			for(int i = 0; i < iters; i++){
+				pid_t pid;
+				t1 = now_sec();
+				pid = spawn_one(m);
+				call += now_sec() - t1;
+				if(pid == -1){
+					fails++;
+					continue;
+				}
+				reap_one(m, pid);
+			}
+			if(fails)
+				printf(" %13s(%4d)", "fail", fails);
+			else
+				printf(" %10.0f %9.1f", iters / (now_sec() - t0), call / iters * 1e6);
+			fflush(stdout);
+		}
+		printf("\n");
+	}
+
+	zygote_stop(&zyg);
+	return 0;
+}
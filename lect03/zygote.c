@@ -0,0 +1,212 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <spawn.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "zygote.h"
+
+extern char **environ;
+
+enum { ZYG_SPAWNED = 1, ZYG_EXITED = 2 };
+
+typedef struct {
+	int type;
+	pid_t pid;
+	int value;                  // SPAWNED: 0 또는 errno, EXITED: status
+} zyg_reply;
+
+/* 요청 "path\0arg0\0arg1\0..." 를 posix_spawn 으로 실행 */
+static void zyg_handle(int sock, char *msg, size_t len, const posix_spawnattr_t *attr){
+	char *argv[1024];
+	int argc = 0;
+	size_t off = strlen(msg) + 1;
+	zyg_reply r = { ZYG_SPAWNED, -1, 0 };
+
+	while(off < len && argc < 1023){
+		argv[argc++] = msg + off;
+		off += strlen(msg + off) + 1;
+	}
+	argv[argc] = NULL;
+	r.value = posix_spawn(&r.pid, msg, NULL, attr, argv, environ);
+	send(sock, &r, sizeof(r), 0);
+}
+
+static void zyg_reap(int sock){
+	zyg_reply r = { ZYG_EXITED, 0, 0 };
+
+	while((r.pid = waitpid(-1, &r.value, WNOHANG)) > 0)
+		send(sock, &r, sizeof(r), 0);
+}
+
+static void zyg_main(int sock){
+	char *msg = malloc(ZYG_MSG_MAX);
+	posix_spawnattr_t attr;
+	sigset_t mask, empty;
+	struct pollfd pfd[2];
+	int sfd, alive = 1;
+
+	// SIGCHLD 는 signalfd 로 받고, 자식에게는 빈 마스크를 물려준다
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	sigprocmask(SIG_BLOCK, &mask, NULL);
+	sfd = signalfd(-1, &mask, SFD_NONBLOCK|SFD_CLOEXEC);
+	sigemptyset(&empty);
+	posix_spawnattr_init(&attr);
+	posix_spawnattr_setsigmask(&attr, &empty);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+
+	pfd[0] = (struct pollfd){ .fd = sock, .events = POLLIN };
+	pfd[1] = (struct pollfd){ .fd = sfd, .events = POLLIN };
+	while(alive){
+		if(poll(pfd, 2, -1) == -1){
+			if(errno == EINTR) continue;
+			break;
+		}
+		if(pfd[1].revents & POLLIN){
+			struct signalfd_siginfo si;
+			while(read(sfd, &si, sizeof(si)) == sizeof(si))
+				;
+			zyg_reap(sock);
+		}
+		if(pfd[0].revents & (POLLIN|POLLHUP)){
+			ssize_t n = recv(sock, msg, ZYG_MSG_MAX, 0);
+			if(n <= 0)
+				alive = 0;      // 부모가 연결을 끊었다
+			else
+				zyg_handle(sock, msg, n, &attr);
+		}
+	}
+	// 남은 자식을 모두 거두고 끝낸다
+	while(wait(NULL) > 0)
+		;
+	_exit(0);
+}
+
+int zygote_start(zygote *z){
+	int sv[2];
+
+	memset(z, 0, sizeof(*z));
+	if(socketpair(AF_UNIX, SOCK_SEQPACKET|SOCK_CLOEXEC, 0, sv) == -1)
+		return -1;
+	if((z->pid = fork()) == -1){
+		close(sv[0]);
+		close(sv[1]);
+		return -1;
+	}
+	if(z->pid == 0){
+		close(sv[0]);
+		zyg_main(sv[1]);
+	}
+	close(sv[1]);
+	z->sock = sv[0];
+	return 0;
+}
+
+static int zyg_recv(zygote *z, zyg_reply *r){
+	ssize_t n;
+
+	do{
+		n = recv(z->sock, r, sizeof(*r), 0);
+	}while(n == -1 && errno == EINTR);
+	return n == sizeof(*r) ? 0 : -1;
+}
+
+static int zyg_push(zygote *z, pid_t pid, int status){
+	if(z->npending == z->cap){
+		int cap = z->cap ? z->cap * 2 : 64;
+		zyg_exit *np = realloc(z->pending, sizeof(zyg_exit) * cap);
+		if(np == NULL)
+			return -1;
+		z->pending = np;
+		z->cap = cap;
+	}
+	z->pending[z->npending++] = (zyg_exit){ pid, status };
+	return 0;
+}
+
+pid_t zygote_spawn(zygote *z, const char *path, char *const argv[]){
+	char *msg = malloc(ZYG_MSG_MAX);
+	size_t len = 0, l;
+	zyg_reply r;
+	int lost = 0;
+
+	if(msg == NULL)
+		return -1;
+	l = strlen(path) + 1;
+	if(l > ZYG_MSG_MAX){
+		free(msg);
+		errno = E2BIG;
+		return -1;
+	}
+	memcpy(msg, path, l);
+	len = l;
+	for(int i = 0; argv[i]; i++){
+		l = strlen(argv[i]) + 1;
+		if(len + l > ZYG_MSG_MAX){
+			free(msg);
+			errno = E2BIG;
+			return -1;
+		}
+		memcpy(msg + len, argv[i], l);
+		len += l;
+	}
+	if(send(z->sock, msg, len, 0) == -1){
+		free(msg);
+		return -1;
+	}
+	free(msg);
+
+	// 응답 전에 도착한 종료 통지는 모아 두었다가 zygote_wait 에서 돌려준다
+	while(zyg_recv(z, &r) == 0){
+		if(r.type == ZYG_EXITED){
+			if(zyg_push(z, r.pid, r.value) < 0)
+				lost = 1;
+			continue;
+		}
+		// 통지를 잃었으면 응답까지는 읽어서 프로토콜을 맞춘 뒤 실패로 알린다
+		if(lost){
+			errno = ENOMEM;
+			return -1;
+		}
+		if(r.value != 0){
+			errno = r.value;
+			return -1;
+		}
+		return r.pid;
+	}
+	return -1;
+}
+
+int zygote_wait(zygote *z, pid_t *pid, int *status){
+	zyg_reply r;
+
+	if(z->npending > 0){
+		zyg_exit e = z->pending[--z->npending];
+		*pid = e.pid;
+		*status = e.status;
+		return 0;
+	}
+	while(zyg_recv(z, &r) == 0){
+		if(r.type == ZYG_EXITED){
+			*pid = r.pid;
+			*status = r.value;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+void zygote_stop(zygote *z){
+	close(z->sock);
+	waitpid(z->pid, NULL, 0);
+	free(z->pending);
+	z->pending = NULL;
+	z->npending = z->cap = 0;
+}
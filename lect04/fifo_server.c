@@ -0,0 +1,328 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "fifo_frame.h"
+
+/* 여러 writer 의 메시지를 받는 FIFO 서버.
+ * npreader.c 는 FIFO 하나를 블로킹으로 읽었지만, 여기서는 FIFO 여러 개를 non-blocking 으로 열고
+ * epoll 로 기다린다. 1 초마다 통계를 찍고, SIGINT/SIGTERM 이나 -n 개를 받으면 끝낸다.
+ * 사용법: ./fifo_server [-n 메시지 수] [-p 파이프 크기] fifo1 [fifo2 ...] */
+
+#define MAX_FIFOS 64
+#define READ_BUF (256 * 1024)
+#define TABLE_SIZE 4096         // 조립 중인 메시지 테이블 (writer pid 로 찾음)
+
+typedef struct {
+	const char *path;
+	int rfd, wfd;           // wfd: writer 가 모두 떠나도 EOF(HUP)가 나지 않도록 잡아 두는 쓰기 끝
+	char *buf;
+	size_t used;            // 프레임 경계가 아닌 곳에서 끊긴 나머지
+	int pipe_size;
+} fifo_in;
+
+/* 메시지 하나가 끝나거나 버려지면 칸을 비운다. 끝내지 못하고 사라진 writer 의 칸은
+ * 테이블이 찼을 때 kill(pid, 0) 으로 확인해서 치운다 */
+typedef struct {
+	uint32_t pid;           // 0 이면 빈 칸
+	uint32_t msg_seq;
+	uint16_t next_frag;
+	uint32_t total;
+	size_t got;
+	char *data;
+} assembly;
+
+static struct {
+	unsigned long long msgs, bytes, frames;
+	unsigned long long bad_frames;      // magic/길이 이상
+	unsigned long long reasm_drops;     // 조각이 빠지거나 순서가 틀려 버린 메시지
+	unsigned long long read_calls, eagain;
+	size_t backlog_max;                 // 파이프에 쌓여 있던 최대 바이트 (backpressure 지표)
+} st;
+
+static assembly table[TABLE_SIZE];
+static int table_used;      // 최소 한 칸은 비워 두어 탐사와 release 가 반드시 빈 칸을 만나게 한다
+
+static unsigned home(uint32_t pid){
+	return (pid * 2654435761u) & (TABLE_SIZE - 1);
+}
+
+/* pid 의 칸. 없으면 create 일 때만 빈 칸을 준다 (찼으면 NULL) */
+static assembly *probe(uint32_t pid, int create){
+	unsigned h = home(pid);
+	for(int i = 0; i < TABLE_SIZE; i++){
+		assembly *a = &table[(h + i) & (TABLE_SIZE - 1)];
+		if(a->pid == pid)
+			return a;
+		if(a->pid == 0){
+			if(!create || table_used >= TABLE_SIZE - 1)
+				return NULL;
+			a->pid = pid;
+			table_used++;
+			return a;
+		}
+	}
+	return NULL;
+}
+
+/* 칸을 비운다. 선형 탐사라서 뒤에 이어진 칸들을 제자리 쪽으로 당겨 탐사가 끊기지 않게 한다 */
+static void release(assembly *a){
+	unsigned i = a - table, j = i;
+
+	free(a->data);
+	a->pid = 0;                 // 빈 칸(i)은 늘 pid 0 이라서 한 바퀴 돌기 전에 멈춘다
+	table_used--;
+	for(;;){
+		j = (j + 1) & (TABLE_SIZE - 1);
+		if(table[j].pid == 0)
+			break;
+		// j 의 항목이 i 에 와도 자기 자리(home)보다 앞이 아니면 옮긴다
+		if(((j - home(table[j].pid)) & (TABLE_SIZE - 1)) >= ((j - i) & (TABLE_SIZE - 1))){
+			table[i] = table[j];
+			table[j].pid = 0;
+			i = j;
+		}
+	}
+	memset(&table[i], 0, sizeof(table[i]));
+}
+
+/* 이미 끝난 writer 의 조립 중인 칸을 치운다 */
+static void reap_dead(void){
+	for(int i = 0; i < TABLE_SIZE; i++){
+		while(table[i].pid != 0 && kill(table[i].pid, 0) == -1 && errno == ESRCH){
+			st.reasm_drops++;
+			release(&table[i]);
+		}
+	}
+}
+
+static assembly *lookup(uint32_t pid, int create){
+	assembly *a = probe(pid, create);
+
+	if(a == NULL && create){
+		reap_dead();
+		a = probe(pid, create);
+	}
+	return a;
+}
+
+static void deliver(uint32_t pid, uint32_t seq, const char *data, size_t len){
+	(void)pid; (void)seq; (void)data;
+	st.msgs++;
+	st.bytes += len;
+}
+
+static void on_frame(const fifo_frame_hdr *h, const char *payload){
+	assembly *a;
+
+	st.frames++;
+	if(h->flags == (FIFO_FRAME_FIRST|FIFO_FRAME_LAST)){
+		deliver(h->pid, h->msg_seq, payload, h->len);
+		return;
+	}
+	// 첫 조각만 칸을 새로 잡는다. 칸이 없는 중간 조각은 앞부분을 잃은 메시지
+	if((a = lookup(h->pid, h->flags & FIFO_FRAME_FIRST)) == NULL){
+		st.reasm_drops++;
+		return;
+	}
+	if(h->flags & FIFO_FRAME_FIRST){
+		if(a->data != NULL)
+			st.reasm_drops++;       // 앞 메시지가 끝나지 않았다
+		a->msg_seq = h->msg_seq;
+		a->total = h->total;
+		a->next_frag = 0;
+		a->got = 0;
+		free(a->data);
+		a->data = malloc(h->total);
+	} else if(a->data == NULL || a->msg_seq != h->msg_seq || a->next_frag != h->frag){
+		st.reasm_drops++;
+		release(a);
+		return;
+	}
+	if(a->data == NULL || a->got + h->len > a->total){
+		st.reasm_drops++;
+		release(a);
+		return;
+	}
+	memcpy(a->data + a->got, payload, h->len);
+	a->got += h->len;
+	a->next_frag++;
+	if(h->flags & FIFO_FRAME_LAST){
+		deliver(h->pid, h->msg_seq, a->data, a->got);
+		release(a);
+	}
+}
+
+/* 버퍼에 있는 완전한 프레임을 모두 처리하고 남은 조각은 앞으로 당긴다 */
+static void parse(fifo_in *f){
+	size_t off = 0;
+
+	while(f->used - off >= sizeof(fifo_frame_hdr)){
+		fifo_frame_hdr h;
+		memcpy(&h, f->buf + off, sizeof(h));
+		if(h.magic != FIFO_FRAME_MAGIC || h.len > FIFO_FRAME_PAYLOAD){
+			// 원자적 쓰기를 어긴 writer 가 있으면 여기로 온다. 한 바이트씩 밀면서 다시 맞춘다
+			st.bad_frames++;
+			off++;
+			continue;
+		}
+		if(f->used - off < sizeof(h) + h.len)
+			break;
+		on_frame(&h, f->buf + off + sizeof(h));
+		off += sizeof(h) + h.len;
+	}
+	memmove(f->buf, f->buf + off, f->used - off);
+	f->used -= off;
+}
+
+static void drain(fifo_in *f){
+	int pending;
+	ssize_t n;
+
+	if(ioctl(f->rfd, FIONREAD, &pending) == 0 && (size_t)pending > st.backlog_max)
+		st.backlog_max = pending;
+	for(;;){
+		n = read(f->rfd, f->buf + f->used, READ_BUF - f->used);
+		st.read_calls++;
+		if(n > 0){
+			f->used += n;
+			parse(f);
+			continue;
+		}
+		if(n == -1 && errno == EINTR)
+			continue;
+		if(n == -1 && errno == EAGAIN)
+			st.eagain++;
+		break;
+	}
+}
+
+static void print_stats(double elapsed, unsigned long long prev_msgs){
+	printf("[%6.1fs] msgs %llu (+%llu/s) frames %llu MB %.1f | backlog max %zu B, "
+			"reasm drops %llu, bad frames %llu, reads %llu (%llu empty)\n",
+			elapsed, st.msgs, st.msgs - prev_msgs, st.frames, st.bytes / 1048576.0,
+			st.backlog_max, st.reasm_drops, st.bad_frames, st.read_calls, st.eagain);
+	fflush(stdout);
+}
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]){
+	fifo_in fifos[MAX_FIFOS];
+	int nfifo = 0, epfd, sfd, tfd, opt;
+	unsigned long long limit = 0, prev_msgs = 0;
+	int pipe_size = 1 << 20;
+	sigset_t mask;
+	struct itimerspec its = { { 1, 0 }, { 1, 0 } };
+	double t_start = 0, t_first = 0, t_last = 0;
+	int done = 0;
+
+	while((opt = getopt(argc, argv, "n:p:")) != -1){
+		if(opt == 'n') limit = strtoull(optarg, NULL, 10);
+		else if(opt == 'p') pipe_size = atoi(optarg);
+		else break;
+	}
+	if(optind >= argc || argc - optind > MAX_FIFOS){
+		fprintf(stderr, "Usage : %s [-n messages] [-p pipe_size] fifo...\n", argv[0]);
+		exit(1);
+	}
+
+	if((epfd = epoll_create1(EPOLL_CLOEXEC)) == -1){
+		perror("epoll_create1");
+		exit(1);
+	}
+	for(int i = optind; i < argc; i++){
+		fifo_in *f = &fifos[nfifo];
+		struct epoll_event ev = { .events = EPOLLIN, .data.ptr = f };
+
+		memset(f, 0, sizeof(*f));
+		f->path = argv[i];
+		unlink(f->path);
+		if(mkfifo(f->path, 0660) == -1){
+			perror("mkfifo");
+			exit(1);
+		}
+		f->rfd = open(f->path, O_RDONLY|O_NONBLOCK);
+		f->wfd = open(f->path, O_WRONLY|O_NONBLOCK);
+		if(f->rfd == -1 || f->wfd == -1){
+			perror("open");
+			exit(1);
+		}
+		// 파이프를 키워서 writer 쪽 EAGAIN 을 줄인다 (/proc/sys/fs/pipe-max-size 까지)
+		f->pipe_size = fcntl(f->rfd, F_SETPIPE_SZ, pipe_size);
+		if(f->pipe_size == -1)
+			f->pipe_size = fcntl(f->rfd, F_GETPIPE_SZ);
+		f->buf = malloc(READ_BUF);
+		epoll_ctl(epfd, EPOLL_CTL_ADD, f->rfd, &ev);
+		nfifo++;
+	}
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGINT);
+	sigaddset(&mask, SIGTERM);
+	sigprocmask(SIG_BLOCK, &mask, NULL);
+	sfd = signalfd(-1, &mask, SFD_NONBLOCK|SFD_CLOEXEC);
+	tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+	timerfd_settime(tfd, 0, &its, NULL);
+	{
+		struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &sfd };
+		epoll_ctl(epfd, EPOLL_CTL_ADD, sfd, &ev);
+		ev.data.ptr = &tfd;
+		epoll_ctl(epfd, EPOLL_CTL_ADD, tfd, &ev);
+	}
+
+	printf("serving %d fifo(s), pipe size %d\n", nfifo, fifos[0].pipe_size);
+	fflush(stdout);
+	t_start = now_sec();
+
+	while(!done){
+		struct epoll_event evs[MAX_FIFOS + 2];
+		int n = epoll_wait(epfd, evs, MAX_FIFOS + 2, -1);
+
+		if(n == -1 && errno == EINTR)
+			continue;
+		for(int i = 0; i < n; i++){
+			if(evs[i].data.ptr == &sfd){
+				done = 1;
+			} else if(evs[i].data.ptr == &tfd){
+				uint64_t ticks;
+				read(tfd, &ticks, sizeof(ticks));
+				print_stats(now_sec() - t_start, prev_msgs);
+				prev_msgs = st.msgs;
+			} else {
+				if(st.msgs == 0)
+					t_first = now_sec();
+				drain(evs[i].data.ptr);
+				t_last = now_sec();
+			}
+		}
+		if(limit > 0 && st.msgs >= limit)
+			done = 1;
+	}
+
+	print_stats(now_sec() - t_start, prev_msgs);
+	if(st.msgs > 0 && t_last > t_first)
+		printf("throughput: %.0f msgs/s (first to last message)\n", st.msgs / (t_last - t_first));
+	for(int i = 0; i < nfifo; i++){
+		close(fifos[i].rfd);
+		close(fifos[i].wfd);
+		unlink(fifos[i].path);
+		free(fifos[i].buf);
+	}
+	return 0;
+}
@@ -0,0 +1,167 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include "fifo_frame.h"
+
+/* fifo_server 부하 생성기. npwriter.c 처럼 FIFO 에 쓰지만 writer 를 여러 개 fork 하고
+ * 메시지를 fifo_frame 으로 나눠 원자적으로 쓴다.
+ * block 모드: 파이프가 가득 차면 poll 로 기다림 / drop 모드: 첫 조각이 EAGAIN 이면 메시지를 버림
+ * 사용법: ./fifo_writer fifo [writers(32)] [writer 당 메시지(10000)] [크기(64)] [block|drop] */
+
+typedef struct {
+	unsigned long long sent, dropped, eagain;
+} writer_stat;
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 서버가 FIFO 를 열 때까지 기다린다. npwriter.c 의 sleep(1) 대신 짧게 물러난다 */
+static int open_fifo(const char *path){
+	int fd;
+	long delay_us = 1000;
+
+	while((fd = open(path, O_WRONLY|O_NONBLOCK)) == -1){
+		if(errno != ENXIO && errno != ENOENT)
+			return -1;
+		usleep(delay_us);
+		if(delay_us < 100000)
+			delay_us *= 2;
+	}
+	return fd;
+}
+
+static int write_frame(int fd, const char *frame, size_t len, int may_drop, writer_stat *ws){
+	for(;;){
+		ssize_t n = write(fd, frame, len);
+		if(n == (ssize_t)len)
+			return 0;
+		if(n == -1 && errno == EAGAIN){
+			ws->eagain++;
+			if(may_drop)
+				return -1;
+			struct pollfd p = { fd, POLLOUT, 0 };
+			poll(&p, 1, -1);
+			continue;
+		}
+		if(n == -1 && errno == EINTR)
+			continue;
+		// PIPE_BUF 이하라 부분 쓰기는 없다
+		perror("write");
+		exit(1);
+	}
+}
+
+static void send_message(int fd, uint32_t seq, const char *data, size_t len, int drop_mode, writer_stat *ws){
+	char frame[FIFO_FRAME_MAX];
+	fifo_frame_hdr h = { FIFO_FRAME_MAGIC, 0, 0, 0, getpid(), seq, len };
+	size_t off = 0;
+
+	do{
+		size_t chunk = len - off < FIFO_FRAME_PAYLOAD ? len - off : FIFO_FRAME_PAYLOAD;
+		h.len = chunk;
+		h.flags = (off == 0 ? FIFO_FRAME_FIRST : 0) | (off + chunk == len ? FIFO_FRAME_LAST : 0);
+		memcpy(frame, &h, sizeof(h));
+		memcpy(frame + sizeof(h), data + off, chunk);
+		// 첫 조각만 버릴 수 있다. 중간에서 버리면 서버에 반쪽 메시지가 남는다
+		if(write_frame(fd, frame, sizeof(h) + chunk, drop_mode && off == 0, ws) == -1){
+			ws->dropped++;
+			return;
+		}
+		off += chunk;
+		h.frag++;
+	}while(off < len);
+	ws->sent++;
+}
+
+/* 10 진수 인자를 [lo, hi] 로 받는다. 아니면 끝낸다 */
+static long parse_arg(const char *s, const char *name, long lo, long hi){
+	char *end;
+	long v;
+
+	errno = 0;
+	v = strtol(s, &end, 10);
+	if(end == s || *end != '\0' || errno == ERANGE || v < lo || v > hi){
+		fprintf(stderr, "bad %s: %s (%ld..%ld)\n", name, s, lo, hi);
+		exit(1);
+	}
+	return v;
+}
+
+int main(int argc, char *argv[]){
+	int writers = 32, size = 64, drop_mode = 0;
+	long msgs = 10000;
+	writer_stat *stats;
+	double t0;
+	unsigned long long sent = 0, dropped = 0, eagain = 0;
+
+	if(argc < 2){
+		fprintf(stderr, "Usage : %s fifo [writers] [msgs] [size] [block|drop]\n", argv[0]);
+		exit(1);
+	}
+	if(argc > 2) writers = parse_arg(argv[2], "writers", 1, 4095);    // 서버 테이블(4096)에 한 칸 남도록
+	if(argc > 3) msgs = parse_arg(argv[3], "msgs", 0, LONG_MAX);
+	if(argc > 4) size = parse_arg(argv[4], "size", 1, 1 << 30);
+	if(argc > 5){
+		if(strcmp(argv[5], "drop") != 0 && strcmp(argv[5], "block") != 0){
+			fprintf(stderr, "bad mode: %s (block|drop)\n", argv[5]);
+			exit(1);
+		}
+		drop_mode = strcmp(argv[5], "drop") == 0;
+	}
+
+	// 자식들의 통계를 모으는 공유 영역
+	stats = mmap(NULL, sizeof(writer_stat) * writers, PROT_READ|PROT_WRITE,
+			MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+	if(stats == MAP_FAILED){
+		perror("mmap");
+		exit(1);
+	}
+	t0 = now_sec();
+	for(int w = 0; w < writers; w++){
+		pid_t pid = fork();
+		if(pid == -1){
+			// 이미 만든 writer 들은 그대로 끝까지 돌게 두고 그만큼만 센다
+			perror("fork");
+			writers = w;
+			break;
+		}
+		if(pid == 0){
+			char *data = malloc(size);
+			int fd = open_fifo(argv[1]);
+			if(data == NULL || fd == -1){
+				perror("open");
+				_exit(1);
+			}
+			memset(data, 'a' + w % 26, size);
+			for(long i = 0; i < msgs; i++)
+				send_message(fd, i, data, size, drop_mode, &stats[w]);
+			close(fd);
+			_exit(0);
+		}
+	}
+	while(wait(NULL) > 0)
+		;
+
+	for(int w = 0; w < writers; w++){
+		sent += stats[w].sent;
+		dropped += stats[w].dropped;
+		eagain += stats[w].eagain;
+	}
+	printf("%d writers: sent %llu, dropped %llu, EAGAIN %llu, %.0f msgs/s\n",
+			writers, sent, dropped, eagain, sent / (now_sec() - t0));
+	return 0;
+}
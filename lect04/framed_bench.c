@@ -0,0 +1,122 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "framed_reader.h"
+
+/* npreader.c 의 1 바이트 readLine() 과 framed_reader 비교.
+ * 자식이 FIFO 에 NULL 로 끝나는 메시지를 쓰고 부모가 읽는다.
+ * 사용법: ./framed_bench [메시지 수(200000)] [메시지 길이(32)] */
+
+#define FIFO_NAME "benchPipe"
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 기존 npreader.c 방식 (str 은 충분히 크게 잡아서 넘침만 피한다) */
+static int readLine(int fd, char *str){
+	int n;
+	do{
+		n = read(fd, str, 1);
+	}while(n > 0 && *str++ != '\0');
+
+	return (n > 0);
+}
+
+static pid_t start_writer(long count, int len){
+	pid_t pid = fork();
+
+	if(pid == 0){
+		int fd = open(FIFO_NAME, O_WRONLY);
+		size_t chunk = 64 * 1024, used = 0;
+		char *buf = malloc(chunk + len + 1);
+
+		// 쓰는 쪽이 병목이 되지 않도록 여러 메시지를 모아서 쓴다
+		for(long i = 0; i < count; i++){
+			memset(buf + used, 'a' + i % 26, len);
+			used += len;
+			buf[used++] = '\0';
+			if(used >= chunk){
+				write(fd, buf, used);
+				used = 0;
+			}
+		}
+		if(used > 0)
+			write(fd, buf, used);
+		close(fd);
+		_exit(0);
+	}
+	return pid;
+}
+
+static void run(int buffered, long count, int len){
+	pid_t pid;
+	int fd;
+	long n = 0;
+	size_t bytes = 0;
+	double t0, dt;
+
+	unlink(FIFO_NAME);
+	mkfifo(FIFO_NAME, 0660);
+	pid = start_writer(count, len);
+	fd = open(FIFO_NAME, O_RDONLY);
+	t0 = now_sec();
+
+	if(buffered){
+		framed_reader rd;
+		const char *str;
+		size_t l;
+		frd_init(&rd, fd, 64 * 1024);
+		while(frd_next_delim(&rd, '\0', &str, &l) > 0){
+			n++;
+			bytes += l + 1;
+		}
+		frd_free(&rd);
+	} else {
+		char *str = malloc(len + 1);
+		while(readLine(fd, str)){
+			n++;
+			bytes += strlen(str) + 1;
+		}
+		free(str);
+	}
+
+	dt = now_sec() - t0;
+	close(fd);
+	waitpid(pid, NULL, 0);
+	unlink(FIFO_NAME);
+
+	if(n != count){
+		fprintf(stderr, "expected %ld messages, got %ld\n", count, n);
+		exit(1);
+	}
+	printf("%-16s %12.0f %10.1f\n", buffered ? "framed_reader" : "readLine (1B)",
+			n / dt, bytes / dt / 1048576.0);
+}
+
+int main(int argc, char *argv[]){
+	long count = 200000;
+	int len = 32;
+
+	if(argc > 1) count = atol(argv[1]);
+	if(argc > 2) len = atoi(argv[2]);
+	if(count < 1 || len < 1){
+		fprintf(stderr, "Usage : %s [messages] [length]\n", argv[0]);
+		exit(1);
+	}
+
+	printf("%ld messages x %d bytes\n", count, len + 1);
+	printf("%-16s %12s %10s\n", "reader", "msgs/s", "MB/s");
+	run(0, count, len);
+	run(1, count, len);
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "framed_reader.h"
+
+int frd_init(framed_reader *r, int fd, size_t initial_cap){
+	memset(r, 0, sizeof(*r));
+	r->fd = fd;
+	r->cap = initial_cap < 64 ? 64 : initial_cap;
+	if((r->buf = malloc(r->cap)) == NULL)
+		return -1;
+	return 0;
+}
+
+void frd_free(framed_reader *r){
+	free(r->buf);
+	r->buf = NULL;
+}
+
+/* 버퍼에 최소 한 번 더 읽어 들인다. 꺼낸 부분은 앞으로 당기고, 가득 찼으면 두 배로 키운다.
+ * 읽은 바이트 수, EOF 면 0, 오류면 -1 */
+static ssize_t fill(framed_reader *r){
+	ssize_t n;
+
+	if(r->start > 0){
+		memmove(r->buf, r->buf + r->start, r->end - r->start);
+		r->end -= r->start;
+		r->scanned -= r->start;
+		r->start = 0;
+	}
+	if(r->end == r->cap){
+		char *nb = realloc(r->buf, r->cap * 2);
+		if(nb == NULL)
+			return -1;
+		r->buf = nb;
+		r->cap *= 2;
+	}
+	do{
+		n = read(r->fd, r->buf + r->end, r->cap - r->end);
+	}while(n == -1 && errno == EINTR);
+	if(n > 0)
+		r->end += n;
+	else if(n == 0)
+		r->eof = 1;
+	return n;
+}
+
+int frd_next_delim(framed_reader *r, char delim, const char **frame, size_t *len){
+	for(;;){
+		char *p = memchr(r->buf + r->scanned, delim, r->end - r->scanned);
+		if(p != NULL){
+			*frame = r->buf + r->start;
+			*len = p - *frame;
+			r->start = r->scanned = p - r->buf + 1;
+			return 1;
+		}
+		r->scanned = r->end;
+
+		if(r->eof || fill(r) <= 0){
+			if(r->end > r->start && r->eof){
+				*frame = r->buf + r->start;
+				*len = r->end - r->start;
+				r->start = r->scanned = r->end;
+				return 1;
+			}
+			return r->eof ? 0 : -1;
+		}
+	}
+}
+
+int frd_next_len(framed_reader *r, const char **frame, size_t *len){
+	for(;;){
+		size_t avail = r->end - r->start;
+		uint32_t n;
+
+		if(avail >= sizeof(n)){
+			memcpy(&n, r->buf + r->start, sizeof(n));
+			if(avail >= sizeof(n) + n){
+				*frame = r->buf + r->start + sizeof(n);
+				*len = n;
+				r->start += sizeof(n) + n;
+				r->scanned = r->start;
+				return 1;
+			}
+		}
+		if(r->eof || fill(r) <= 0)
+			return r->eof ? 0 : -1;
+	}
+}
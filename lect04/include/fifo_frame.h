@@ -0,0 +1,28 @@
+#ifndef FIFO_FRAME_H
+#define FIFO_FRAME_H
+
+#include <limits.h>
+#include <stdint.h>
+
+/* 여러 writer 가 같은 FIFO 에 쓸 때 쓰는 프레임.
+ * PIPE_BUF 이하의 write() 는 원자적이므로 프레임 하나가 다른 writer 의 데이터와
+ * 섞이지 않는다. PIPE_BUF 보다 큰 메시지는 조각(frag)으로 나누고 msg_seq/frag 로 다시 붙인다. */
+
+#define FIFO_FRAME_MAGIC 0xF1F0u
+#define FIFO_FRAME_FIRST 0x1
+#define FIFO_FRAME_LAST  0x2
+
+typedef struct {
+	uint16_t magic;
+	uint16_t len;           // 이 프레임의 payload 길이
+	uint16_t flags;         // FIRST/LAST
+	uint16_t frag;          // 메시지 안에서 몇 번째 조각인지
+	uint32_t pid;           // 보낸 writer
+	uint32_t msg_seq;       // writer 별 메시지 번호
+	uint32_t total;         // 메시지 전체 길이
+} fifo_frame_hdr;
+
+#define FIFO_FRAME_MAX PIPE_BUF
+#define FIFO_FRAME_PAYLOAD (FIFO_FRAME_MAX - (int)sizeof(fifo_frame_hdr))
+
+#endif
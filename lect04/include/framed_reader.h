@@ -0,0 +1,30 @@
+#ifndef FRAMED_READER_H
+#define FRAMED_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* fd 에서 크게 읽어 버퍼에 모아 두고 프레임 단위로 꺼내는 리더.
+ * 돌려주는 프레임 포인터는 버퍼 안을 가리키며 다음 호출 전까지만 유효하다.
+ * 프레임이 버퍼보다 크면 버퍼를 키우므로 최대 메시지 길이 제한이 없다. */
+typedef struct {
+	int fd;
+	char *buf;
+	size_t cap;
+	size_t start;       // 아직 꺼내지 않은 데이터의 시작
+	size_t end;         // 읽어 둔 데이터의 끝
+	size_t scanned;     // 구분자를 이미 찾아본 위치 (같은 바이트를 다시 보지 않게)
+	int eof;
+} framed_reader;
+
+int frd_init(framed_reader *r, int fd, size_t initial_cap);
+void frd_free(framed_reader *r);
+
+/* delim 으로 끝나는 프레임 하나 (delim 은 len 에 포함하지 않지만 frame[len] 에 그대로 남아 있다).
+ * 1: 프레임 있음, 0: EOF, -1: 오류. EOF 직전에 구분자 없이 남은 데이터는 마지막 프레임으로 돌려준다 */
+int frd_next_delim(framed_reader *r, char delim, const char **frame, size_t *len);
+
+/* [u32 길이(호스트 바이트 순서)][payload] 형식의 프레임 하나 */
+int frd_next_len(framed_reader *r, const char **frame, size_t *len);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef MLOG_H
+#define MLOG_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* 메모리 매핑 파일 위의 추가 전용(append-only) 로그.
+ *
+ * 파일 구조:
+ *   [헤더 4KB][레코드][레코드]...
+ *   레코드 = [u32 길이][u32 crc32c][payload][8 바이트 정렬 패딩]
+ * 헤더의 end 는 완전히 쓰인 레코드의 끝 위치다. 쓰는 쪽은 레코드를 다 쓴 뒤에
+ * end 를 올리므로, 다른 프로세스는 end 까지만 읽으면 항상 온전한 레코드를 본다. */
+
+#define MLOG_HEADER_SIZE 4096
+
+typedef enum {
+	MLOG_SYNC_NONE,         // msync 안 함 (커널이 알아서 내려씀)
+	MLOG_SYNC_EACH,         // 레코드마다 msync
+	MLOG_SYNC_EVERY_N,      // N 개마다
+	MLOG_SYNC_INTERVAL      // 마지막 msync 뒤 interval_ns 가 지나면
+} mlog_sync_mode;
+
+typedef struct {
+	mlog_sync_mode mode;
+	unsigned every_n;
+	long long interval_ns;
+} mlog_sync_policy;
+
+typedef struct {
+	uint64_t magic;
+	atomic_uint_fast64_t end;   // 유효한 데이터의 끝 (파일 안 오프셋)
+	atomic_uint notify;         // 추가될 때마다 증가 (futex 워드)
+	atomic_uint waiters;        // tail 하며 잠든 reader 수
+} mlog_header;
+
+typedef struct {
+	int fd;
+	char *base;
+	size_t capacity;            // 현재 파일/매핑 크기
+	mlog_header *hdr;
+	mlog_sync_policy policy;
+	size_t synced;              // 여기까지는 msync 됨
+	unsigned unsynced_records;
+	long long last_sync_ns;
+	/* 통계 */
+	unsigned long long syncs;
+	long long sync_ns_total;
+	long long sync_ns_max;
+} mlog_writer;
+
+typedef struct {
+	int fd;
+	const char *base;           // 레코드 영역 (읽기 전용)
+	size_t mapped;
+	size_t pos;                 // 다음에 읽을 레코드 위치
+	mlog_header *hdr;           // 헤더 페이지만 따로 쓰기 가능하게 매핑 (waiters 용)
+} mlog_reader;
+
+/* prealloc 바이트를 fallocate 로 미리 잡는다. 기존 로그가 있으면 이어서 쓴다 */
+int mlog_open(mlog_writer *w, const char *path, size_t prealloc, const mlog_sync_policy *policy);
+int mlog_append(mlog_writer *w, const void *data, uint32_t len);
+/* 정책과 상관없이 지금까지 쓴 것을 디스크로 */
+int mlog_sync(mlog_writer *w);
+void mlog_close(mlog_writer *w);
+
+int mlog_reader_open(mlog_reader *r, const char *path);
+/* 다음 레코드를 복사 없이 돌려준다. 1: 있음, 0: 아직 없음, -1: 손상/오류 */
+int mlog_next(mlog_reader *r, const void **data, uint32_t *len);
+/* 새 레코드가 올 때까지 최대 timeout_ms 기다린다 (음수면 무한) */
+void mlog_reader_wait(mlog_reader *r, int timeout_ms);
+void mlog_reader_close(mlog_reader *r);
+
+uint32_t mlog_crc32c(const void *data, size_t len);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef MMAP_ENGINE_H
+#define MMAP_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 청크마다 실행할 연산. state 는 워커마다 하나씩 만들고 끝에 merge 로 합친다. */
+typedef struct {
+	const char *name;
+	size_t state_size;
+	void (*init)(void *state);
+	/* off: 파일 안에서 p 의 위치 */
+	void (*chunk)(void *state, const char *p, size_t len, size_t off);
+	void (*merge)(void *dst, const void *src);
+	void (*print)(const void *state);
+} mf_op;
+
+/* 기본 제공 연산 */
+typedef struct { uint64_t count[256]; } mf_hist_state;
+typedef struct { uint64_t lines; } mf_lines_state;
+typedef struct { uint64_t sum, weighted; } mf_sum_state;
+
+extern const mf_op mf_op_histogram;
+extern const mf_op mf_op_linecount;
+extern const mf_op mf_op_checksum;
+
+#define MF_ADV_SEQUENTIAL 0x1
+#define MF_ADV_WILLNEED   0x2
+#define MF_ADV_HUGEPAGE   0x4
+
+typedef struct {
+	int nworkers;       // 1 이면 호출한 스레드에서 바로 처리
+	int use_fork;       // 0: pthread, 1: fork 한 자식 프로세스
+	int advice;         // MF_ADV_* 조합
+	char delim;         // 레코드 구분자 (청크 경계를 이 문자 다음으로 맞춘다)
+} mf_opts;
+
+/* path 를 통째로 mmap 해서 op 를 돌리고 결과를 result(op->state_size)에 넣는다.
+ * 성공 0, 실패 -1 (errno 유지) */
+int mf_run(const char *path, const mf_op *op, void *result, const mf_opts *opts);
+
+/* 같은 연산을 read() 로 처리 (비교용) */
+int mf_run_read(const char *path, const mf_op *op, void *result, size_t bufsize);
+
+#endif
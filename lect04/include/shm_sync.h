@@ -0,0 +1,51 @@
+#ifndef SHM_SYNC_H
+#define SHM_SYNC_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* 공유 매핑 맨 앞에 놓이는 헤더. 데이터는 헤더 바로 뒤(64 바이트 정렬)에 온다.
+ * fork 전후 어느 프로세스에서든 같은 주소/같은 파일로 보면 된다. */
+typedef struct {
+	uint32_t magic;
+	uint32_t header_size;
+	size_t data_size;
+	pthread_mutex_t mtx;        // PTHREAD_PROCESS_SHARED + ROBUST
+	pthread_cond_t cond;        // PTHREAD_PROCESS_SHARED
+	_Alignas(64) atomic_uint futex;     // futex 대기/깨우기용 워드
+	_Alignas(64) atomic_uint seq;       // seqlock 순번 (홀수면 쓰는 중)
+} shm_header;
+
+typedef struct {
+	shm_header *hdr;
+	size_t map_size;
+} shm_region;
+
+/* path 가 NULL 이면 익명 공유 매핑(fork 로만 공유), 아니면 파일을 만들고 크기를 맞춰 매핑.
+ * 성공 0, 실패 -1 */
+int shm_region_create(shm_region *r, const char *path, size_t data_size);
+/* 이미 만들어진 파일을 다른 프로세스에서 연다 */
+int shm_region_open(shm_region *r, const char *path);
+void shm_region_close(shm_region *r);
+void *shm_data(shm_region *r);
+
+/* mutex / condvar. 잠근 프로세스가 죽었으면 복구하고 1 을 돌려준다 */
+int shm_lock(shm_region *r);
+void shm_unlock(shm_region *r);
+void shm_cond_wait(shm_region *r);
+void shm_cond_broadcast(shm_region *r);
+
+/* futex: 워드가 expected 일 때만 잠든다 */
+void shm_futex_wait(shm_region *r, unsigned expected);
+void shm_futex_wake(shm_region *r, int n);
+
+/* seqlock: 쓰는 쪽은 begin/end 사이에서 데이터를 고치고,
+ * 읽는 쪽은 begin 으로 순번을 받은 뒤 읽고 retry 가 0 일 때까지 반복 */
+void shm_seq_write_begin(shm_region *r);
+void shm_seq_write_end(shm_region *r);
+unsigned shm_seq_read_begin(shm_region *r);
+int shm_seq_read_retry(shm_region *r, unsigned start);
+
+#endif
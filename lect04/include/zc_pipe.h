@@ -0,0 +1,39 @@
+#ifndef ZC_PIPE_H
+#define ZC_PIPE_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/* IPC_pipe.c 의 write/read 복사 대신 vmsplice/splice/tee 로 파이프를 쓰는 도구들.
+ *
+ * vmsplice 주의점: SPLICE_F_GIFT 없이 보내면 파이프가 사용자 페이지를 그대로 참조한다.
+ * 읽는 쪽이 가져가기 전에 버퍼를 고치면 고친 내용이 전달된다. zc_ring 은 버퍼를
+ * 파이프 크기 단위로 두 칸 돌려 써서, 다시 쓰는 칸은 이미 소비된 것이 보장되게 한다.
+ * (읽는 쪽이 read() 로 복사하거나 /dev/null, 파일로 splice 할 때 성립한다.
+ *  다른 파이프로 splice/tee 해서 넘기면 페이지 참조가 그쪽으로 옮겨갈 뿐이므로 성립하지 않는다) */
+
+/* 파이프 용량을 바꾸고 실제 크기를 돌려준다 (실패하면 -1) */
+int zc_pipe_setsize(int fd, int size);
+
+/* 모두 보낼/받을 때까지 반복. 보낸/받은 바이트 수, 오류면 -1 */
+ssize_t zc_write_all(int fd, const void *buf, size_t len);
+ssize_t zc_read_all(int fd, void *buf, size_t len);
+ssize_t zc_vmsplice_all(int pipe_w, const void *buf, size_t len);
+/* 파이프에서 out_fd 로 len 바이트 (EOF 면 그때까지) */
+ssize_t zc_splice_all(int pipe_r, int out_fd, size_t len);
+/* pipe_r 의 내용을 소비하지 않고 pipe_w 로 복제 (최대 len) */
+ssize_t zc_tee(int pipe_r, int pipe_w, size_t len);
+
+/* 안전하게 다시 쓸 수 있는 송신 버퍼 링 */
+typedef struct {
+	char *buf[2];
+	size_t chunk;       // 칸 하나 크기 = 파이프 용량
+	int next;
+} zc_ring;
+
+int zc_ring_init(zc_ring *r, size_t pipe_size);
+void zc_ring_free(zc_ring *r);
+/* 채워도 되는 다음 칸. 직전 칸을 vmsplice 로 다 보냈다면 이 칸의 페이지는 이미 소비되었다 */
+char *zc_ring_next(zc_ring *r);
+
+#endif
@@ -0,0 +1,535 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+/* 강의 코드에 나온 IPC 를 한 자리에서 비교하는 벤치마크.
+ *   pipe (IPC_pipe.c), fifo (npreader/npwriter), mmap 메일박스 (memMapping.c),
+ *   signal (signal_handler.c, 스케줄러의 SIGUSR1 -> 여기서는 payload 를 세기 위해 실시간 시그널),
+ *   unix 소켓, eventfd, 공유 메모리 링 버퍼
+ * 각 방식, 메시지 크기(8 B ~ 1 MB), CPU 고정(none/same/diff)마다
+ * 왕복 지연의 절반(p50/p99)과 한 방향 스트리밍 처리량을 CSV 로 출력한다.
+ * 사용법: ./ipc_bench [scale(1.0)] > ipc.csv     (scale 로 반복 횟수를 줄이거나 늘림) */
+
+#define MAX_MSG (1 << 20)
+#define RING_SIZE (4 << 20)
+#define SPIN_BEFORE_WAIT 2000
+
+/* ---- 공유 메모리 구조 ---- */
+
+typedef struct {
+	atomic_uint state;          // 0: 비었음, 1: 찼음 (futex 워드)
+	size_t len;
+	char data[MAX_MSG];
+} mailbox;
+
+typedef struct {
+	_Alignas(64) atomic_size_t head;    // 쓴 위치
+	_Alignas(64) atomic_size_t tail;    // 읽은 위치
+	_Alignas(64) atomic_uint ev;        // head/tail 이 움직일 때마다 증가 (futex 워드)
+	atomic_int waiters;
+	char data[RING_SIZE];
+} ring;
+
+/* dir 0: 부모 -> 자식, dir 1: 자식 -> 부모 */
+typedef struct {
+	int fd[2][2];               // [dir][0 읽기 / 1 쓰기]
+	char fifo_path[2][64];
+	mailbox *mb[2];
+	ring *rg[2];
+	pid_t peer;
+	int is_child;
+} chan;
+
+typedef struct {
+	const char *name;
+	int max_size;
+	int (*setup)(chan *c);
+	void (*attach)(chan *c, int is_child);   // fork 뒤 각자 필요한 끝만 남긴다
+	void (*send)(chan *c, int dir, const char *buf, size_t len);
+	void (*recv)(chan *c, int dir, char *buf, size_t len);
+	void (*teardown)(chan *c);
+} mech;
+
+static void futex_wait(atomic_uint *w, unsigned val){
+	syscall(SYS_futex, w, FUTEX_WAIT, val, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint *w){
+	syscall(SYS_futex, w, FUTEX_WAKE, 0x7fffffff, NULL, NULL, 0);
+}
+
+static void die(const char *what){
+	perror(what);
+	exit(1);
+}
+
+/* ---- fd 기반 공통 ---- */
+
+static void fd_send(chan *c, int dir, const char *buf, size_t len){
+	while(len > 0){
+		ssize_t n = write(c->fd[dir][1], buf, len);
+		if(n == -1){
+			if(errno == EINTR) continue;
+			die("write");
+		}
+		buf += n;
+		len -= n;
+	}
+}
+
+static void fd_recv(chan *c, int dir, char *buf, size_t len){
+	while(len > 0){
+		ssize_t n = read(c->fd[dir][0], buf, len);
+		if(n <= 0){
+			if(n == -1 && errno == EINTR) continue;
+			die("read");
+		}
+		buf += n;
+		len -= n;
+	}
+}
+
+static void fd_attach(chan *c, int is_child){
+	// 부모는 dir0 에 쓰고 dir1 에서 읽는다. 자식은 반대
+	close(c->fd[0][is_child ? 1 : 0]);
+	close(c->fd[1][is_child ? 0 : 1]);
+	c->fd[0][is_child ? 1 : 0] = -1;
+	c->fd[1][is_child ? 0 : 1] = -1;
+}
+
+static void fd_teardown(chan *c){
+	for(int d = 0; d < 2; d++)
+		for(int e = 0; e < 2; e++)
+			if(c->fd[d][e] >= 0)
+				close(c->fd[d][e]);
+}
+
+/* ---- pipe ---- */
+
+static int pipe_setup(chan *c){
+	if(pipe(c->fd[0]) == -1 || pipe(c->fd[1]) == -1)
+		return -1;
+	fcntl(c->fd[0][1], F_SETPIPE_SZ, MAX_MSG);
+	fcntl(c->fd[1][1], F_SETPIPE_SZ, MAX_MSG);
+	return 0;
+}
+
+/* ---- fifo: 경로만 만들고 fork 뒤에 연다 ---- */
+
+static int fifo_setup(chan *c){
+	for(int d = 0; d < 2; d++){
+		snprintf(c->fifo_path[d], sizeof(c->fifo_path[d]), "/tmp/ipc_bench_%d_%d", getpid(), d);
+		unlink(c->fifo_path[d]);
+		if(mkfifo(c->fifo_path[d], 0600) == -1)
+			return -1;
+		c->fd[d][0] = c->fd[d][1] = -1;
+	}
+	return 0;
+}
+
+static void fifo_attach(chan *c, int is_child){
+	// 양쪽이 같은 순서(dir0 먼저)로 열어야 open 끼리 막히지 않는다
+	if(is_child){
+		c->fd[0][0] = open(c->fifo_path[0], O_RDONLY);
+		c->fd[1][1] = open(c->fifo_path[1], O_WRONLY);
+	} else {
+		c->fd[0][1] = open(c->fifo_path[0], O_WRONLY);
+		c->fd[1][0] = open(c->fifo_path[1], O_RDONLY);
+		fcntl(c->fd[0][1], F_SETPIPE_SZ, MAX_MSG);
+		fcntl(c->fd[1][0], F_SETPIPE_SZ, MAX_MSG);
+	}
+}
+
+static void fifo_teardown(chan *c){
+	fd_teardown(c);
+	if(!c->is_child){
+		unlink(c->fifo_path[0]);
+		unlink(c->fifo_path[1]);
+	}
+}
+
+/* ---- unix 도메인 소켓 ---- */
+
+static int unix_setup(chan *c){
+	int sv[2], sz = MAX_MSG * 2;
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+		return -1;
+	for(int i = 0; i < 2; i++){
+		setsockopt(sv[i], SOL_SOCKET, SO_SNDBUF, &sz, sizeof(sz));
+		setsockopt(sv[i], SOL_SOCKET, SO_RCVBUF, &sz, sizeof(sz));
+	}
+	// 부모 쪽 sv[0], 자식 쪽 sv[1]. 양방향이므로 dir 별 fd 를 같은 소켓으로 채운다
+	c->fd[0][1] = c->fd[1][0] = sv[0];
+	c->fd[0][0] = c->fd[1][1] = sv[1];
+	return 0;
+}
+
+static void unix_attach(chan *c, int is_child){
+	int mine = is_child ? c->fd[0][0] : c->fd[0][1];
+	close(is_child ? c->fd[0][1] : c->fd[0][0]);
+	c->fd[0][0] = c->fd[0][1] = c->fd[1][0] = c->fd[1][1] = mine;
+}
+
+static void unix_teardown(chan *c){
+	close(c->fd[0][0]);
+}
+
+/* ---- eventfd: 8 바이트 카운터만 주고받는다 (세마포어 모드라 메시지가 합쳐지지 않음) ---- */
+
+static int eventfd_setup(chan *c){
+	for(int d = 0; d < 2; d++){
+		if((c->fd[d][0] = eventfd(0, EFD_SEMAPHORE)) == -1)
+			return -1;
+		c->fd[d][1] = c->fd[d][0];
+	}
+	return 0;
+}
+
+static void eventfd_attach(chan *c, int is_child){
+	(void)c; (void)is_child;
+}
+
+static void eventfd_send(chan *c, int dir, const char *buf, size_t len){
+	uint64_t one = 1;
+	(void)buf; (void)len;
+	if(write(c->fd[dir][1], &one, sizeof(one)) != sizeof(one))
+		die("eventfd write");
+}
+
+static void eventfd_recv(chan *c, int dir, char *buf, size_t len){
+	uint64_t v;
+	(void)len;
+	if(read(c->fd[dir][0], &v, sizeof(v)) != sizeof(v))
+		die("eventfd read");
+	memcpy(buf, &v, sizeof(v));
+}
+
+static void eventfd_teardown(chan *c){
+	close(c->fd[0][0]);
+	close(c->fd[1][0]);
+}
+
+/* ---- signal: sigqueue 로 실시간 시그널을 보내고 sigwaitinfo 로 받는다 (payload 8 바이트) ---- */
+
+#define SIG_MSG (SIGRTMIN + 1)
+
+static int signal_setup(chan *c){
+	sigset_t set;
+	(void)c;
+	sigemptyset(&set);
+	sigaddset(&set, SIG_MSG);
+	return sigprocmask(SIG_BLOCK, &set, NULL);
+}
+
+static void signal_attach(chan *c, int is_child){
+	c->peer = is_child ? getppid() : c->peer;
+}
+
+static void signal_send(chan *c, int dir, const char *buf, size_t len){
+	union sigval v;
+	(void)dir; (void)len;
+	memcpy(&v.sival_ptr, buf, sizeof(v.sival_ptr));
+	// 받는 쪽 큐가 가득 차면(EAGAIN) 잠깐 양보하고 다시
+	while(sigqueue(c->peer, SIG_MSG, v) == -1){
+		if(errno != EAGAIN)
+			die("sigqueue");
+		sched_yield();
+	}
+}
+
+static void signal_recv(chan *c, int dir, char *buf, size_t len){
+	sigset_t set;
+	siginfo_t si;
+	(void)c; (void)dir; (void)len;
+	sigemptyset(&set);
+	sigaddset(&set, SIG_MSG);
+	while(sigwaitinfo(&set, &si) == -1)
+		;
+	memcpy(buf, &si.si_value.sival_ptr, sizeof(si.si_value.sival_ptr));
+}
+
+static void signal_teardown(chan *c){
+	sigset_t set;
+	(void)c;
+	sigemptyset(&set);
+	sigaddset(&set, SIG_MSG);
+	sigprocmask(SIG_UNBLOCK, &set, NULL);
+}
+
+/* ---- mmap 메일박스: memMapping.c 의 공유 매핑에 한 칸짜리 우편함 + futex ---- */
+
+static int mailbox_setup(chan *c){
+	for(int d = 0; d < 2; d++){
+		c->mb[d] = mmap(NULL, sizeof(mailbox), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+		if(c->mb[d] == MAP_FAILED)
+			return -1;
+	}
+	return 0;
+}
+
+static void shm_attach(chan *c, int is_child){
+	(void)c; (void)is_child;
+}
+
+static void wait_state(atomic_uint *w, unsigned busy){
+	for(int i = 0; i < SPIN_BEFORE_WAIT; i++)
+		if(atomic_load_explicit(w, memory_order_acquire) != busy)
+			return;
+	while(atomic_load_explicit(w, memory_order_acquire) == busy)
+		futex_wait(w, busy);
+}
+
+static void mailbox_send(chan *c, int dir, const char *buf, size_t len){
+	mailbox *m = c->mb[dir];
+	wait_state(&m->state, 1);
+	memcpy(m->data, buf, len);
+	m->len = len;
+	atomic_store_explicit(&m->state, 1, memory_order_release);
+	futex_wake(&m->state);
+}
+
+static void mailbox_recv(chan *c, int dir, char *buf, size_t len){
+	mailbox *m = c->mb[dir];
+	wait_state(&m->state, 0);
+	memcpy(buf, m->data, len < m->len ? len : m->len);
+	atomic_store_explicit(&m->state, 0, memory_order_release);
+	futex_wake(&m->state);
+}
+
+static void mailbox_teardown(chan *c){
+	munmap(c->mb[0], sizeof(mailbox));
+	munmap(c->mb[1], sizeof(mailbox));
+}
+
+/* ---- 공유 메모리 링 (SPSC 바이트 스트림) ---- */
+
+static int ring_setup(chan *c){
+	for(int d = 0; d < 2; d++){
+		c->rg[d] = mmap(NULL, sizeof(ring), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+		if(c->rg[d] == MAP_FAILED)
+			return -1;
+	}
+	return 0;
+}
+
+static void ring_notify(ring *r){
+	atomic_fetch_add(&r->ev, 1);
+	if(atomic_load(&r->waiters) > 0)
+		futex_wake(&r->ev);
+}
+
+/* cond 가 참이 될 때까지: 잠깐 돌다가 futex 로 잔다 */
+#define RING_WAIT(r, cond) do {                                  \
+		int spins_ = 0;                                          \
+		while(!(cond)){                                          \
+			if(++spins_ < SPIN_BEFORE_WAIT) continue;            \
+			unsigned e_ = atomic_load(&(r)->ev);                 \
+			atomic_fetch_add(&(r)->waiters, 1);                  \
+			if(!(cond))                                          \
+				futex_wait(&(r)->ev, e_);                        \
+			atomic_fetch_sub(&(r)->waiters, 1);                  \
+		}                                                        \
+	} while(0)
+
+static void ring_send(chan *c, int dir, const char *buf, size_t len){
+	ring *r = c->rg[dir];
+	size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+
+	while(len > 0){
+		size_t space, n, off;
+		RING_WAIT(r, RING_SIZE - (head - atomic_load_explicit(&r->tail, memory_order_acquire)) > 0);
+		space = RING_SIZE - (head - atomic_load_explicit(&r->tail, memory_order_acquire));
+		off = head % RING_SIZE;
+		n = len < space ? len : space;
+		if(n > RING_SIZE - off)
+			n = RING_SIZE - off;
+		memcpy(r->data + off, buf, n);
+		head += n;
+		buf += n;
+		len -= n;
+		atomic_store_explicit(&r->head, head, memory_order_release);
+		ring_notify(r);
+	}
+}
+
+static void ring_recv(chan *c, int dir, char *buf, size_t len){
+	ring *r = c->rg[dir];
+	size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+
+	while(len > 0){
+		size_t avail, n, off;
+		RING_WAIT(r, atomic_load_explicit(&r->head, memory_order_acquire) != tail);
+		avail = atomic_load_explicit(&r->head, memory_order_acquire) - tail;
+		off = tail % RING_SIZE;
+		n = len < avail ? len : avail;
+		if(n > RING_SIZE - off)
+			n = RING_SIZE - off;
+		memcpy(buf, r->data + off, n);
+		tail += n;
+		buf += n;
+		len -= n;
+		atomic_store_explicit(&r->tail, tail, memory_order_release);
+		ring_notify(r);
+	}
+}
+
+static void ring_teardown(chan *c){
+	munmap(c->rg[0], sizeof(ring));
+	munmap(c->rg[1], sizeof(ring));
+}
+
+static const mech mechs[] = {
+	{ "pipe",    0, pipe_setup,    fd_attach,      fd_send,      fd_recv,      fd_teardown },
+	{ "fifo",    0, fifo_setup,    fifo_attach,    fd_send,      fd_recv,      fifo_teardown },
+	{ "unix",    0, unix_setup,    unix_attach,    fd_send,      fd_recv,      unix_teardown },
+	{ "eventfd", 8, eventfd_setup, eventfd_attach, eventfd_send, eventfd_recv, eventfd_teardown },
+	{ "signal",  8, signal_setup,  signal_attach,  signal_send,  signal_recv,  signal_teardown },
+	{ "mmap",    0, mailbox_setup, shm_attach,     mailbox_send, mailbox_recv, mailbox_teardown },
+	{ "shmring", 0, ring_setup,    shm_attach,     ring_send,    ring_recv,    ring_teardown },
+};
+
+/* ---- 측정 ---- */
+
+enum { PIN_NONE, PIN_SAME, PIN_DIFF };
+static const char *pin_name[] = { "none", "same", "diff" };
+static cpu_set_t all_cpus;
+
+static void pin(int mode, int is_child){
+	cpu_set_t set;
+
+	if(mode == PIN_NONE){
+		sched_setaffinity(0, sizeof(all_cpus), &all_cpus);
+		return;
+	}
+	// all_cpus 에서 첫 번째, 두 번째 CPU 를 고른다
+	int first = -1, second = -1;
+	for(int i = 0; i < CPU_SETSIZE; i++){
+		if(CPU_ISSET(i, &all_cpus)){
+			if(first < 0) first = i;
+			else { second = i; break; }
+		}
+	}
+	CPU_ZERO(&set);
+	CPU_SET(mode == PIN_DIFF && is_child ? second : first, &set);
+	sched_setaffinity(0, sizeof(set), &set);
+}
+
+static long long now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int cmp_ll(const void *a, const void *b){
+	long long x = *(const long long *)a, y = *(const long long *)b;
+	return (x > y) - (x < y);
+}
+
+static void run(const mech *m, int pin_mode, size_t size, double scale){
+	chan c;
+	pid_t pid;
+	char *buf = malloc(size < 8 ? 8 : size);
+	long iters = (long)(20000 * scale / (1 + size / 16384));
+	long stream = (long)((64LL << 20) * scale / size);
+	long long *lat, t0, stream_ns;
+
+	if(iters < 10) iters = 10;
+	if(stream < 100) stream = 100;
+	if(stream > (long)(200000 * scale) && size <= 8) stream = (long)(200000 * scale);
+	lat = malloc(sizeof(long long) * iters);
+	memset(buf, 'x', size);
+
+	memset(&c, 0, sizeof(c));
+	if(m->setup(&c) == -1)
+		die(m->name);
+
+	if((pid = fork()) == 0){
+		c.is_child = 1;
+		pin(pin_mode, 1);
+		m->attach(&c, 1);
+		for(long i = 0; i < iters; i++){
+			m->recv(&c, 0, buf, size);
+			m->send(&c, 1, buf, size);
+		}
+		for(long i = 0; i < stream; i++)
+			m->recv(&c, 0, buf, size);
+		m->send(&c, 1, buf, size < 8 ? size : 8);     // 다 받았다는 확인
+		m->teardown(&c);
+		_exit(0);
+	}
+	c.peer = pid;
+	pin(pin_mode, 0);
+	m->attach(&c, 0);
+
+	for(long i = 0; i < iters; i++){
+		t0 = now_ns();
+		m->send(&c, 0, buf, size);
+		m->recv(&c, 1, buf, size);
+		lat[i] = (now_ns() - t0) / 2;
+	}
+	t0 = now_ns();
+	for(long i = 0; i < stream; i++)
+		m->send(&c, 0, buf, size);
+	m->recv(&c, 1, buf, size < 8 ? size : 8);
+	stream_ns = now_ns() - t0;
+
+	waitpid(pid, NULL, 0);
+	m->teardown(&c);
+	pin(PIN_NONE, 0);
+
+	qsort(lat, iters, sizeof(lat[0]), cmp_ll);
+	printf("%s,%zu,%s,%lld,%lld,%.1f,%.0f\n", m->name, size, pin_name[pin_mode],
+			lat[iters / 2], lat[iters * 99 / 100],
+			(double)size * stream / (stream_ns / 1e9) / 1048576.0, stream / (stream_ns / 1e9));
+	fflush(stdout);
+	free(lat);
+	free(buf);
+}
+
+int main(int argc, char *argv[]){
+	double scale = 1.0;
+	int npin;
+
+	if(argc > 1) scale = atof(argv[1]);
+	if(scale <= 0){
+		fprintf(stderr, "Usage : %s [scale]\n", argv[0]);
+		exit(1);
+	}
+	sched_getaffinity(0, sizeof(all_cpus), &all_cpus);
+	// CPU 가 하나뿐이면 diff 는 할 수 없다
+	npin = CPU_COUNT(&all_cpus) >= 2 ? 3 : 2;
+	if(npin == 2)
+		fprintf(stderr, "only one CPU available: skipping diff-core runs\n");
+
+	printf("mechanism,size,pinning,p50_ns,p99_ns,stream_MBps,stream_msgs_per_s\n");
+	for(unsigned k = 0; k < sizeof(mechs) / sizeof(mechs[0]); k++){
+		for(size_t size = 8; size <= MAX_MSG; size *= 8){
+			if(mechs[k].max_size && size > (size_t)mechs[k].max_size)
+				break;
+			for(int p = 0; p < npin; p++)
+				run(&mechs[k], p, size, scale);
+		}
+		// 1 MB 도 꼭 포함 (8 의 거듭제곱으로는 빠진다)
+		if(mechs[k].max_size == 0)
+			for(int p = 0; p < npin; p++)
+				run(&mechs[k], p, MAX_MSG, scale);
+	}
+	return 0;
+}
@@ -0,0 +1,286 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include "mlog.h"
+
+#define MLOG_MAGIC 0x474f4c4d4d41504dULL  // "MPAMMLOG"
+#define REC_HDR 8
+#define ALIGN8(x) (((x) + 7) & ~(size_t)7)
+
+static long long now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ---- CRC32C (Castagnoli) ---- */
+
+static uint32_t crc_table[256];
+
+static void crc_init(void){
+	for(uint32_t i = 0; i < 256; i++){
+		uint32_t c = i;
+		for(int k = 0; k < 8; k++)
+			c = c & 1 ? (c >> 1) ^ 0x82f63b78u : c >> 1;
+		crc_table[i] = c;
+	}
+}
+
+uint32_t mlog_crc32c(const void *data, size_t len){
+	const unsigned char *p = data;
+	uint32_t c = ~0u;
+
+#if defined(__SSE4_2__) && defined(__x86_64__)
+	for(; len >= 8; len -= 8, p += 8){
+		uint64_t v;
+		memcpy(&v, p, 8);
+		c = (uint32_t)__builtin_ia32_crc32di(c, v);
+	}
+	for(; len > 0; len--)
+		c = __builtin_ia32_crc32qi(c, *p++);
+#else
+	if(crc_table[1] == 0)
+		crc_init();
+	for(; len > 0; len--)
+		c = crc_table[(c ^ *p++) & 0xff] ^ (c >> 8);
+#endif
+	return ~c;
+}
+
+/* ---- writer ---- */
+
+static int map_writer(mlog_writer *w, size_t size){
+	void *addr;
+
+	if(w->base == NULL)
+		addr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, w->fd, (off_t)0);
+	else
+		addr = mremap(w->base, w->capacity, size, MREMAP_MAYMOVE);
+	if(addr == MAP_FAILED)
+		return -1;
+	w->base = addr;
+	w->capacity = size;
+	w->hdr = addr;
+	return 0;
+}
+
+/* 파일을 size 까지 키운다. fallocate 가 안 되는 파일시스템이면 ftruncate 만 */
+static int grow_file(int fd, size_t size){
+	if(fallocate(fd, 0, 0, size) == 0)
+		return 0;
+	return ftruncate(fd, size);
+}
+
+int mlog_open(mlog_writer *w, const char *path, size_t prealloc, const mlog_sync_policy *policy){
+	struct stat statbuf;
+	size_t size;
+
+	memset(w, 0, sizeof(*w));
+	if(policy != NULL)
+		w->policy = *policy;
+	if((w->fd = open(path, O_RDWR|O_CREAT, 0660)) == -1)
+		return -1;
+	if(fstat(w->fd, &statbuf) == -1)
+		goto fail;
+
+	size = statbuf.st_size;
+	if(size < MLOG_HEADER_SIZE + prealloc)
+		size = MLOG_HEADER_SIZE + prealloc;
+	size = (size + 4095) & ~(size_t)4095;
+	if((size_t)statbuf.st_size < size && grow_file(w->fd, size) == -1)
+		goto fail;
+	if(map_writer(w, size) == -1)
+		goto fail;
+
+	if(w->hdr->magic != MLOG_MAGIC){
+		atomic_store(&w->hdr->end, MLOG_HEADER_SIZE);
+		atomic_store(&w->hdr->notify, 0);
+		atomic_store(&w->hdr->waiters, 0);
+		w->hdr->magic = MLOG_MAGIC;
+	}
+	w->synced = atomic_load(&w->hdr->end);
+	w->last_sync_ns = now_ns();
+	return 0;
+
+fail:
+	close(w->fd);
+	return -1;
+}
+
+static int sync_range(mlog_writer *w, size_t from, size_t to){
+	long long t0 = now_ns(), dt;
+	size_t start = from & ~(size_t)4095;
+
+	if(msync(w->base + start, to - start, MS_SYNC) == -1)
+		return -1;
+	// 끝 위치가 들어 있는 헤더 페이지도
+	if(msync(w->base, MLOG_HEADER_SIZE, MS_SYNC) == -1)
+		return -1;
+	dt = now_ns() - t0;
+	w->syncs++;
+	w->sync_ns_total += dt;
+	if(dt > w->sync_ns_max)
+		w->sync_ns_max = dt;
+	return 0;
+}
+
+int mlog_sync(mlog_writer *w){
+	size_t end = atomic_load_explicit(&w->hdr->end, memory_order_relaxed);
+
+	if(end > w->synced && sync_range(w, w->synced, end) == -1)
+		return -1;
+	w->synced = end;
+	w->unsynced_records = 0;
+	w->last_sync_ns = now_ns();
+	return 0;
+}
+
+int mlog_append(mlog_writer *w, const void *data, uint32_t len){
+	size_t end = atomic_load_explicit(&w->hdr->end, memory_order_relaxed);
+	size_t rec = ALIGN8(REC_HDR + (size_t)len);
+	uint32_t h[2];
+	int need_sync = 0;
+
+	if(end + rec > w->capacity){
+		size_t size = w->capacity * 2;
+		while(end + rec > size)
+			size *= 2;
+		if(grow_file(w->fd, size) == -1 || map_writer(w, size) == -1)
+			return -1;
+	}
+
+	h[0] = len;
+	h[1] = mlog_crc32c(data, len);
+	memcpy(w->base + end, h, REC_HDR);
+	memcpy(w->base + end + REC_HDR, data, len);
+
+	// 레코드를 다 쓴 다음에 end 를 공개한다
+	atomic_store_explicit(&w->hdr->end, end + rec, memory_order_release);
+	atomic_fetch_add_explicit(&w->hdr->notify, 1, memory_order_release);
+	if(atomic_load(&w->hdr->waiters) > 0)
+		syscall(SYS_futex, &w->hdr->notify, FUTEX_WAKE, 0x7fffffff, NULL, NULL, 0);
+
+	w->unsynced_records++;
+	switch(w->policy.mode){
+	case MLOG_SYNC_EACH:
+		need_sync = 1;
+		break;
+	case MLOG_SYNC_EVERY_N:
+		need_sync = w->unsynced_records >= (w->policy.every_n ? w->policy.every_n : 1);
+		break;
+	case MLOG_SYNC_INTERVAL:
+		need_sync = now_ns() - w->last_sync_ns >= w->policy.interval_ns;
+		break;
+	default:
+		break;
+	}
+	return need_sync ? mlog_sync(w) : 0;
+}
+
+void mlog_close(mlog_writer *w){
+	if(w->policy.mode != MLOG_SYNC_NONE)
+		mlog_sync(w);
+	munmap(w->base, w->capacity);
+	close(w->fd);
+	w->base = NULL;
+}
+
+/* ---- reader ---- */
+
+static int remap_reader(mlog_reader *r){
+	struct stat statbuf;
+	void *addr;
+
+	if(fstat(r->fd, &statbuf) == -1)
+		return -1;
+	if((size_t)statbuf.st_size <= r->mapped)
+		return 0;
+	if(r->base == NULL)
+		addr = mmap(NULL, statbuf.st_size, PROT_READ, MAP_SHARED, r->fd, (off_t)0);
+	else
+		addr = mremap((void *)r->base, r->mapped, statbuf.st_size, MREMAP_MAYMOVE);
+	if(addr == MAP_FAILED)
+		return -1;
+	r->base = addr;
+	r->mapped = statbuf.st_size;
+	return 0;
+}
+
+int mlog_reader_open(mlog_reader *r, const char *path){
+	memset(r, 0, sizeof(*r));
+	// 헤더의 waiters 를 고치려면 쓰기 권한이 필요하다. 없으면 시간 제한 폴링만 한다
+	if((r->fd = open(path, O_RDWR)) == -1 && (r->fd = open(path, O_RDONLY)) == -1)
+		return -1;
+	if(remap_reader(r) == -1 || r->mapped < MLOG_HEADER_SIZE ||
+			((const mlog_header *)r->base)->magic != MLOG_MAGIC){
+		if(r->base != NULL)
+			munmap((void *)r->base, r->mapped);
+		close(r->fd);
+		errno = EINVAL;
+		return -1;
+	}
+	r->hdr = mmap(NULL, MLOG_HEADER_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED, r->fd, (off_t)0);
+	if(r->hdr == MAP_FAILED)
+		r->hdr = NULL;
+	r->pos = MLOG_HEADER_SIZE;
+	return 0;
+}
+
+int mlog_next(mlog_reader *r, const void **data, uint32_t *len){
+	mlog_header *hdr = (mlog_header *)r->base;
+	size_t end = atomic_load_explicit(&hdr->end, memory_order_acquire);
+	uint32_t h[2];
+
+	if(r->pos >= end)
+		return 0;
+	// 쓰는 쪽이 파일을 키웠으면 다시 매핑
+	if(end > r->mapped && remap_reader(r) == -1)
+		return -1;
+
+	memcpy(h, r->base + r->pos, REC_HDR);
+	if(r->pos + ALIGN8(REC_HDR + (size_t)h[0]) > end)
+		return -1;
+	if(mlog_crc32c(r->base + r->pos + REC_HDR, h[0]) != h[1])
+		return -1;
+	*data = r->base + r->pos + REC_HDR;
+	*len = h[0];
+	r->pos += ALIGN8(REC_HDR + (size_t)h[0]);
+	return 1;
+}
+
+void mlog_reader_wait(mlog_reader *r, int timeout_ms){
+	const mlog_header *hdr = (const mlog_header *)r->base;
+	unsigned seq = atomic_load((atomic_uint *)&hdr->notify);
+	struct timespec ts, *tp = NULL;
+
+	if(timeout_ms >= 0){
+		ts.tv_sec = timeout_ms / 1000;
+		ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+		tp = &ts;
+	}
+	if(r->hdr == NULL){
+		if(r->pos >= atomic_load((atomic_uint_fast64_t *)&hdr->end))
+			nanosleep(tp != NULL ? tp : &(struct timespec){ 0, 1000000L }, NULL);
+		return;
+	}
+	// waiters 를 올린 뒤 다시 확인해야 쓰는 쪽의 wake 를 놓치지 않는다
+	atomic_fetch_add(&r->hdr->waiters, 1);
+	if(r->pos >= atomic_load(&r->hdr->end))
+		syscall(SYS_futex, &r->hdr->notify, FUTEX_WAIT, seq, tp, NULL, 0);
+	atomic_fetch_sub(&r->hdr->waiters, 1);
+}
+
+void mlog_reader_close(mlog_reader *r){
+	if(r->hdr != NULL)
+		munmap(r->hdr, MLOG_HEADER_SIZE);
+	if(r->base != NULL)
+		munmap((void *)r->base, r->mapped);
+	close(r->fd);
+}
@@ -0,0 +1,123 @@
+#define _GNU_SOURCE
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "mlog.h"
+
+/* 추가 전용 로그의 내구성 모드별 appends/sec 와 msync 지연.
+ * 각 모드마다 자식 프로세스가 같은 파일을 tail 하면서 레코드 수와 내용을 확인한다.
+ * 사용법: ./mlog_bench [파일(mlog.dat)] [레코드 수(20000)] [레코드 크기(128)]
+ *         ./mlog_bench tail 파일     (다른 터미널에서 로그를 따라 읽기) */
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int tail(const char *path, long expect){
+	mlog_reader r;
+	const void *data;
+	uint32_t len;
+	long n = 0;
+	int rc;
+
+	if(mlog_reader_open(&r, path) == -1){
+		perror("mlog_reader_open");
+		return 1;
+	}
+	while(expect < 0 || n < expect){
+		while((rc = mlog_next(&r, &data, &len)) == 1){
+			// 레코드 앞에 번호를 넣었으므로 순서를 확인
+			long seq;
+			memcpy(&seq, data, sizeof(seq));
+			if(seq != n){
+				fprintf(stderr, "tail: expected %ld got %ld\n", n, seq);
+				return 1;
+			}
+			if(expect < 0)
+				printf("%ld: %u bytes\n", seq, len);
+			n++;
+		}
+		if(rc == -1){
+			fprintf(stderr, "tail: corrupt record after %ld\n", n);
+			return 1;
+		}
+		if(expect < 0 || n < expect)
+			mlog_reader_wait(&r, 100);
+	}
+	mlog_reader_close(&r);
+	return 0;
+}
+
+int main(int argc, char *argv[]){
+	const char *path = "mlog.dat";
+	long records = 20000;
+	int size = 128;
+	char *buf;
+
+	if(argc > 2 && strcmp(argv[1], "tail") == 0)
+		return tail(argv[2], -1);
+	if(argc > 1) path = argv[1];
+	if(argc > 2) records = atol(argv[2]);
+	if(argc > 3) size = atoi(argv[3]);
+	if(records < 1 || size < (int)sizeof(long)){
+		fprintf(stderr, "Usage : %s [file] [records] [record_size]\n", argv[0]);
+		exit(1);
+	}
+
+	struct {
+		const char *name;
+		mlog_sync_policy policy;
+	} modes[] = {
+		{ "none",        { MLOG_SYNC_NONE, 0, 0 } },
+		{ "each",        { MLOG_SYNC_EACH, 0, 0 } },
+		{ "every 64",    { MLOG_SYNC_EVERY_N, 64, 0 } },
+		{ "every 1024",  { MLOG_SYNC_EVERY_N, 1024, 0 } },
+		{ "1 ms",        { MLOG_SYNC_INTERVAL, 0, 1000000LL } },
+		{ "10 ms",       { MLOG_SYNC_INTERVAL, 0, 10000000LL } },
+	};
+	int nmodes = sizeof(modes) / sizeof(modes[0]);
+
+	buf = malloc(size);
+	memset(buf, 'a', size);
+
+	printf("%-12s %12s %8s %12s %12s  %s\n", "mode", "appends/s", "msyncs", "avg(us)", "max(us)", "tail");
+	for(int m = 0; m < nmodes; m++){
+		mlog_writer w;
+		pid_t pid;
+		int status;
+		double t0, dt;
+
+		unlink(path);
+		// 작게 잡아서 벤치 중에 ftruncate/mremap 로 커지는 경로도 지나가게 한다
+		if(mlog_open(&w, path, 64 * 1024, &modes[m].policy) == -1){
+			perror("mlog_open");
+			exit(1);
+		}
+		if((pid = fork()) == 0)
+			_exit(tail(path, records));
+
+		t0 = now_sec();
+		for(long i = 0; i < records; i++){
+			memcpy(buf, &i, sizeof(i));
+			if(mlog_append(&w, buf, size) == -1){
+				perror("mlog_append");
+				exit(1);
+			}
+		}
+		dt = now_sec() - t0;
+		waitpid(pid, &status, 0);
+
+		printf("%-12s %12.0f %8llu %12.1f %12.1f  %s\n", modes[m].name, records / dt, w.syncs,
+				w.syncs ? w.sync_ns_total / 1e3 / w.syncs : 0.0, w.sync_ns_max / 1e3,
+				WIFEXITED(status) && WEXITSTATUS(status) == 0 ? "ok" : "FAIL");
+		mlog_close(&w);
+	}
+	unlink(path);
+	free(buf);
+	return 0;
+}
@@ -0,0 +1,123 @@
+#define _GNU_SOURCE
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "mmap_engine.h"
+
+/* read() / mmap 1개 / 병렬 mmap(스레드, fork) 처리량 비교.
+ * cold: 측정 전에 posix_fadvise(DONTNEED)로 페이지 캐시에서 파일을 내린다.
+ * 사용법: ./mmap_bench filename [workers(CPU 수)] [op: lines|histogram|checksum] [생성 MB] */
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void drop_cache(const char *path){
+	int fd = open(path, O_RDONLY);
+	if(fd == -1)
+		return;
+	fdatasync(fd);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	close(fd);
+}
+
+/* 길이가 제각각인 텍스트 줄로 채운 파일을 만든다 */
+static int generate(const char *path, long mb){
+	FILE *fp = fopen(path, "w");
+	long long target = mb * 1024LL * 1024, written = 0;
+	unsigned seed = 1;
+
+	if(fp == NULL)
+		return -1;
+	while(written < target){
+		int len = rand_r(&seed) % 120;
+		for(int i = 0; i < len; i++)
+			fputc('a' + (i + len) % 26, fp);
+		fputc('\n', fp);
+		written += len + 1;
+	}
+	return fclose(fp);
+}
+
+int main(int argc, char *argv[]){
+	struct stat statbuf;
+	const mf_op *op = &mf_op_linecount;
+	int workers = sysconf(_SC_NPROCESSORS_ONLN);
+	void *result, *check;
+
+	if(argc < 2){
+		fprintf(stderr, "Usage : %s filename [workers] [lines|histogram|checksum] [gen_MB]\n", argv[0]);
+		exit(1);
+	}
+	if(argc > 2) workers = atoi(argv[2]);
+	if(argc > 3){
+		if(strcmp(argv[3], "histogram") == 0) op = &mf_op_histogram;
+		else if(strcmp(argv[3], "checksum") == 0) op = &mf_op_checksum;
+	}
+	if(argc > 4 && generate(argv[1], atol(argv[4])) != 0){
+		perror("generate");
+		exit(1);
+	}
+	if(stat(argv[1], &statbuf) == -1){
+		perror("stat");
+		exit(1);
+	}
+	result = malloc(op->state_size);
+	check = malloc(op->state_size);
+
+	struct {
+		const char *name;
+		mf_opts opts;
+		int use_read;
+	} modes[] = {
+		{ "read(1MB)",       { 1, 0, 0, '\n' }, 1 },
+		{ "mmap x1",         { 1, 0, MF_ADV_SEQUENTIAL, '\n' }, 0 },
+		{ "mmap x1 willneed", { 1, 0, MF_ADV_SEQUENTIAL|MF_ADV_WILLNEED, '\n' }, 0 },
+		{ "mmap threads",    { workers, 0, MF_ADV_SEQUENTIAL|MF_ADV_HUGEPAGE, '\n' }, 0 },
+		{ "mmap fork",       { workers, 1, MF_ADV_SEQUENTIAL|MF_ADV_HUGEPAGE, '\n' }, 0 },
+	};
+	int nmodes = sizeof(modes) / sizeof(modes[0]);
+
+	printf("file %s, %.1f MB, op %s, workers %d\n",
+			argv[1], statbuf.st_size / 1048576.0, op->name, workers);
+	printf("%-18s %12s %12s\n", "mode", "cold MB/s", "warm MB/s");
+
+	for(int m = 0; m < nmodes; m++){
+		double mbps[2];
+		for(int warm = 0; warm <= 1; warm++){
+			double t0;
+			int rc;
+			if(!warm)
+				drop_cache(argv[1]);
+			t0 = now_sec();
+			if(modes[m].use_read)
+				rc = mf_run_read(argv[1], op, result, 1 << 20);
+			else
+				rc = mf_run(argv[1], op, result, &modes[m].opts);
+			mbps[warm] = statbuf.st_size / 1048576.0 / (now_sec() - t0);
+			if(rc != 0){
+				perror(modes[m].name);
+				exit(1);
+			}
+			// 모든 방식의 결과가 read() 와 같아야 한다
+			if(m == 0 && !warm)
+				memcpy(check, result, op->state_size);
+			else if(memcmp(check, result, op->state_size) != 0){
+				fprintf(stderr, "%s: result mismatch\n", modes[m].name);
+				exit(1);
+			}
+		}
+		printf("%-18s %12.1f %12.1f\n", modes[m].name, mbps[0], mbps[1]);
+	}
+	op->print(result);
+
+	free(result);
+	free(check);
+	return 0;
+}
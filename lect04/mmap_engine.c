@@ -0,0 +1,260 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "mmap_engine.h"
+
+#define MAX_WORKERS 256
+
+/* ---- 기본 연산 ---- */
+
+static void hist_init(void *s){ memset(s, 0, sizeof(mf_hist_state)); }
+
+static void hist_chunk(void *s, const char *p, size_t len, size_t off){
+	// 카운터 4벌로 같은 칸 연속 증가의 의존성을 줄인다
+	uint64_t c[4][256];
+	const unsigned char *u = (const unsigned char *)p;
+	size_t i = 0;
+
+	(void)off;
+	memset(c, 0, sizeof(c));
+	for(; i + 4 <= len; i += 4){
+		c[0][u[i]]++;
+		c[1][u[i + 1]]++;
+		c[2][u[i + 2]]++;
+		c[3][u[i + 3]]++;
+	}
+	for(; i < len; i++)
+		c[0][u[i]]++;
+	for(int b = 0; b < 256; b++)
+		((mf_hist_state *)s)->count[b] += c[0][b] + c[1][b] + c[2][b] + c[3][b];
+}
+
+static void hist_merge(void *d, const void *s){
+	for(int b = 0; b < 256; b++)
+		((mf_hist_state *)d)->count[b] += ((const mf_hist_state *)s)->count[b];
+}
+
+static void hist_print(const void *s){
+	const mf_hist_state *h = s;
+	for(int b = 0; b < 256; b++)
+		if(h->count[b])
+			printf("0x%02x %llu\n", b, (unsigned long long)h->count[b]);
+}
+
+static void lines_init(void *s){ memset(s, 0, sizeof(mf_lines_state)); }
+
+static void lines_chunk(void *s, const char *p, size_t len, size_t off){
+	const char *end = p + len;
+	uint64_t n = 0;
+
+	(void)off;
+	while((p = memchr(p, '\n', end - p)) != NULL){
+		n++;
+		p++;
+	}
+	((mf_lines_state *)s)->lines += n;
+}
+
+static void lines_merge(void *d, const void *s){
+	((mf_lines_state *)d)->lines += ((const mf_lines_state *)s)->lines;
+}
+
+static void lines_print(const void *s){
+	printf("lines %llu\n", (unsigned long long)((const mf_lines_state *)s)->lines);
+}
+
+/* 위치 가중 합: 청크를 어떻게 나눠도 더하기만 하면 같은 값이 나온다 */
+static void sum_init(void *s){ memset(s, 0, sizeof(mf_sum_state)); }
+
+static void sum_chunk(void *s, const char *p, size_t len, size_t off){
+	const unsigned char *u = (const unsigned char *)p;
+	uint64_t sum = 0, weighted = 0;
+
+	for(size_t i = 0; i < len; i++){
+		sum += u[i];
+		weighted += (uint64_t)u[i] * (off + i + 1);
+	}
+	((mf_sum_state *)s)->sum += sum;
+	((mf_sum_state *)s)->weighted += weighted;
+}
+
+static void sum_merge(void *d, const void *s){
+	((mf_sum_state *)d)->sum += ((const mf_sum_state *)s)->sum;
+	((mf_sum_state *)d)->weighted += ((const mf_sum_state *)s)->weighted;
+}
+
+static void sum_print(const void *s){
+	const mf_sum_state *c = s;
+	printf("checksum %016llx%016llx\n", (unsigned long long)c->sum, (unsigned long long)c->weighted);
+}
+
+const mf_op mf_op_histogram = { "histogram", sizeof(mf_hist_state), hist_init, hist_chunk, hist_merge, hist_print };
+const mf_op mf_op_linecount = { "lines", sizeof(mf_lines_state), lines_init, lines_chunk, lines_merge, lines_print };
+const mf_op mf_op_checksum = { "checksum", sizeof(mf_sum_state), sum_init, sum_chunk, sum_merge, sum_print };
+
+/* ---- 엔진 ---- */
+
+typedef struct {
+	const mf_op *op;
+	const char *base;
+	size_t start, end;
+	void *state;
+} mf_task;
+
+static void *mf_worker(void *argument){
+	mf_task *t = argument;
+	t->op->chunk(t->state, t->base + t->start, t->end - t->start, t->start);
+	return NULL;
+}
+
+/* 경계를 구분자 바로 다음으로 옮긴다 */
+static size_t align_boundary(const char *base, size_t size, size_t pos, char delim){
+	const char *p;
+
+	if(pos == 0 || pos >= size)
+		return pos;
+	p = memchr(base + pos - 1, delim, size - pos + 1);
+	return p ? (size_t)(p - base) + 1 : size;
+}
+
+static void apply_advice(void *addr, size_t size, int advice){
+	if(advice & MF_ADV_SEQUENTIAL)
+		madvise(addr, size, MADV_SEQUENTIAL);
+	if(advice & MF_ADV_WILLNEED)
+		madvise(addr, size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+	// 파일 매핑의 THP 는 커널 설정에 따라 무시될 수 있다
+	if(advice & MF_ADV_HUGEPAGE)
+		madvise(addr, size, MADV_HUGEPAGE);
+#endif
+}
+
+int mf_run(const char *path, const mf_op *op, void *result, const mf_opts *opts){
+	int fd, n, nstates, err = 0;
+	struct stat statbuf;
+	char *addr;
+	char *states;
+	mf_task tasks[MAX_WORKERS];
+	size_t size;
+
+	if((fd = open(path, O_RDONLY)) == -1)
+		return -1;
+	if(fstat(fd, &statbuf) == -1){
+		close(fd);
+		return -1;
+	}
+	size = statbuf.st_size;
+	op->init(result);
+	if(size == 0){
+		close(fd);
+		return 0;
+	}
+
+	addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, (off_t)0);
+	close(fd);
+	if(addr == MAP_FAILED)
+		return -1;
+	apply_advice(addr, size, opts->advice);
+
+	n = opts->nworkers < 1 ? 1 : opts->nworkers > MAX_WORKERS ? MAX_WORKERS : opts->nworkers;
+	if((size_t)n > size)
+		n = size;
+
+	// fork 모드에서도 결과를 볼 수 있도록 state 는 공유 익명 매핑에 둔다
+	nstates = n;
+	states = mmap(NULL, op->state_size * nstates, PROT_READ|PROT_WRITE,
+			MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+	if(states == MAP_FAILED){
+		munmap(addr, size);
+		return -1;
+	}
+
+	for(int i = 0; i < n; i++){
+		tasks[i].op = op;
+		tasks[i].base = addr;
+		tasks[i].start = i == 0 ? 0 : tasks[i - 1].end;
+		tasks[i].end = i == n - 1 ? size
+			: align_boundary(addr, size, size / n * (i + 1), opts->delim);
+		if(tasks[i].end < tasks[i].start)
+			tasks[i].end = tasks[i].start;
+		tasks[i].state = states + op->state_size * i;
+		op->init(tasks[i].state);
+	}
+
+	if(n == 1){
+		mf_worker(&tasks[0]);
+	} else if(opts->use_fork){
+		pid_t pids[MAX_WORKERS];
+		for(int i = 0; i < n; i++){
+			if((pids[i] = fork()) == 0){
+				mf_worker(&tasks[i]);
+				_exit(0);
+			}
+			if(pids[i] < 0){
+				err = errno;
+				n = i;
+				break;
+			}
+		}
+		for(int i = 0; i < n; i++){
+			int status;
+			waitpid(pids[i], &status, 0);
+			if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+				err = EIO;
+		}
+	} else {
+		pthread_t threads[MAX_WORKERS];
+		int created[MAX_WORKERS] = { 0 };
+		// 스레드를 못 만든 조각은 호출한 스레드가 직접 처리한다
+		for(int i = 1; i < n; i++)
+			created[i] = pthread_create(&threads[i], NULL, mf_worker, &tasks[i]) == 0;
+		mf_worker(&tasks[0]);
+		for(int i = 1; i < n; i++){
+			if(created[i])
+				pthread_join(threads[i], NULL);
+			else
+				mf_worker(&tasks[i]);
+		}
+	}
+
+	for(int i = 0; i < n; i++)
+		op->merge(result, tasks[i].state);
+
+	munmap(states, op->state_size * nstates);
+	munmap(addr, size);
+	if(err){
+		errno = err;
+		return -1;
+	}
+	return 0;
+}
+
+int mf_run_read(const char *path, const mf_op *op, void *result, size_t bufsize){
+	int fd;
+	char *buf;
+	ssize_t n;
+	size_t off = 0;
+
+	if((fd = open(path, O_RDONLY)) == -1)
+		return -1;
+	if((buf = malloc(bufsize)) == NULL){
+		close(fd);
+		return -1;
+	}
+	op->init(result);
+	while((n = read(fd, buf, bufsize)) > 0){
+		op->chunk(result, buf, n, off);
+		off += n;
+	}
+	free(buf);
+	close(fd);
+	return n < 0 ? -1 : 0;
+}
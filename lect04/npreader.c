@@ -1,29 +1,36 @@
 #include <stdio.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
-#define MAXLINE 100
+#include "framed_reader.h"
+#define BUFSIZE 4096
 /* 이름 있는 파이프를 통해 읽은 내용을 프린트한다. */
-
-int readLine(int fd, char *str){
-	int n;
-	do{
-		n = read(fd, str,1);
-	}while(n > 0 && *str++ != NULL);
-	
-	return( n > 0 );
-}
+/* 한 바이트씩 read 하지 않고 버퍼에 모아 NULL 단위로 잘라 읽는다 (길이 제한 없음). */
 
 int main(){
 	int fd;
-	char str[MAXLINE];
+	framed_reader rd;
+	const char *str;
+	size_t len;
 	unlink("myPipe");
 	mkfifo("myPipe", 0660);
 	fd = open("myPipe", O_RDONLY);
 
-	while(readLine(fd, str))
-		printf("%s \n", str);
+	if(fd < 0){
+		perror("myPipe");
+		return 1;
+	}
+
+	if(frd_init(&rd, fd, BUFSIZE) < 0){
+		perror("frd_init");
+		close(fd);
+		return 1;
+	}
+	while(frd_next_delim(&rd, '\0', &str, &len) > 0)
+		printf("%.*s \n", (int)len, str);
 	
+	frd_free(&rd);
 	close(fd);
 
 	return 0;
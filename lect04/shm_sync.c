@@ -0,0 +1,162 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include "shm_sync.h"
+
+#define SHM_MAGIC 0x53484d31u  // "SHM1"
+#define HEADER_SIZE ((sizeof(shm_header) + 63) & ~(size_t)63)
+
+static int init_header(shm_header *h, size_t data_size){
+	pthread_mutexattr_t ma;
+	pthread_condattr_t ca;
+
+	memset(h, 0, HEADER_SIZE);
+	h->header_size = HEADER_SIZE;
+	h->data_size = data_size;
+
+	pthread_mutexattr_init(&ma);
+	pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_ROBUST);
+	if(pthread_mutex_init(&h->mtx, &ma) != 0)
+		return -1;
+	pthread_mutexattr_destroy(&ma);
+
+	pthread_condattr_init(&ca);
+	pthread_condattr_setpshared(&ca, PTHREAD_PROCESS_SHARED);
+	if(pthread_cond_init(&h->cond, &ca) != 0)
+		return -1;
+	pthread_condattr_destroy(&ca);
+
+	atomic_init(&h->futex, 0);
+	atomic_init(&h->seq, 0);
+	// 다른 프로세스가 magic 을 보면 나머지도 초기화된 상태
+	atomic_thread_fence(memory_order_release);
+	h->magic = SHM_MAGIC;
+	return 0;
+}
+
+int shm_region_create(shm_region *r, const char *path, size_t data_size){
+	int fd = -1;
+	void *addr;
+
+	r->map_size = HEADER_SIZE + data_size;
+	if(path != NULL){
+		if((fd = open(path, O_RDWR|O_CREAT|O_TRUNC, 0660)) == -1)
+			return -1;
+		if(ftruncate(fd, r->map_size) == -1){
+			close(fd);
+			return -1;
+		}
+		addr = mmap(NULL, r->map_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, (off_t)0);
+		close(fd);
+	} else {
+		addr = mmap(NULL, r->map_size, PROT_READ|PROT_WRITE,
+				MAP_SHARED|MAP_ANONYMOUS, -1, (off_t)0);
+	}
+	if(addr == MAP_FAILED)
+		return -1;
+
+	r->hdr = addr;
+	if(init_header(r->hdr, data_size) != 0){
+		munmap(addr, r->map_size);
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+int shm_region_open(shm_region *r, const char *path){
+	struct stat statbuf;
+	int fd;
+	void *addr;
+
+	if((fd = open(path, O_RDWR)) == -1)
+		return -1;
+	if(fstat(fd, &statbuf) == -1 || (size_t)statbuf.st_size < HEADER_SIZE){
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
+	addr = mmap(NULL, statbuf.st_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, (off_t)0);
+	close(fd);
+	if(addr == MAP_FAILED)
+		return -1;
+
+	r->hdr = addr;
+	r->map_size = statbuf.st_size;
+	if(r->hdr->magic != SHM_MAGIC){
+		munmap(addr, r->map_size);
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+void shm_region_close(shm_region *r){
+	munmap(r->hdr, r->map_size);
+	r->hdr = NULL;
+}
+
+void *shm_data(shm_region *r){
+	return (char *)r->hdr + r->hdr->header_size;
+}
+
+int shm_lock(shm_region *r){
+	int rc = pthread_mutex_lock(&r->hdr->mtx);
+	if(rc == EOWNERDEAD){
+		// 잠근 채 죽은 프로세스가 있었다: 데이터 검사는 호출한 쪽 몫
+		pthread_mutex_consistent(&r->hdr->mtx);
+		return 1;
+	}
+	return 0;
+}
+
+void shm_unlock(shm_region *r){
+	pthread_mutex_unlock(&r->hdr->mtx);
+}
+
+void shm_cond_wait(shm_region *r){
+	if(pthread_cond_wait(&r->hdr->cond, &r->hdr->mtx) == EOWNERDEAD)
+		pthread_mutex_consistent(&r->hdr->mtx);
+}
+
+void shm_cond_broadcast(shm_region *r){
+	pthread_cond_broadcast(&r->hdr->cond);
+}
+
+/* 프로세스끼리 공유하므로 FUTEX_PRIVATE_FLAG 를 쓰면 안 된다 */
+void shm_futex_wait(shm_region *r, unsigned expected){
+	syscall(SYS_futex, &r->hdr->futex, FUTEX_WAIT, expected, NULL, NULL, 0);
+}
+
+void shm_futex_wake(shm_region *r, int n){
+	syscall(SYS_futex, &r->hdr->futex, FUTEX_WAKE, n, NULL, NULL, 0);
+}
+
+void shm_seq_write_begin(shm_region *r){
+	atomic_fetch_add_explicit(&r->hdr->seq, 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+void shm_seq_write_end(shm_region *r){
+	atomic_fetch_add_explicit(&r->hdr->seq, 1, memory_order_release);
+}
+
+unsigned shm_seq_read_begin(shm_region *r){
+	unsigned s;
+	while((s = atomic_load_explicit(&r->hdr->seq, memory_order_acquire)) & 1)
+		sched_yield();   // 쓰는 쪽이 선점당했을 수 있다
+	return s;
+}
+
+int shm_seq_read_retry(shm_region *r, unsigned start){
+	atomic_thread_fence(memory_order_acquire);
+	return atomic_load_explicit(&r->hdr->seq, memory_order_relaxed) != start;
+}
@@ -0,0 +1,184 @@
+#define _GNU_SOURCE
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "shm_sync.h"
+
+/* memMapping.c 의 부모/자식 공유 매핑 주고받기를 방식별로 잰다.
+ * 한 방향 전달 지연(부모 -> 자식 또는 자식 -> 부모)의 p50/p99 를 출력한다.
+ * 사용법: ./shm_sync_bench [rounds(100000)] [sleep rounds(2)] */
+
+typedef struct {
+	int turn;                   // condvar 방식에서 누구 차례인지
+	long long stamp;            // seqlock 방식: 쓴 시각(ns)
+	long round;
+	atomic_long ack;            // seqlock 방식: 읽는 쪽이 확인한 round
+	char msg[64];
+} shared_data;
+
+static long long now_ns(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int cmp_ll(const void *a, const void *b){
+	long long x = *(const long long *)a, y = *(const long long *)b;
+	return (x > y) - (x < y);
+}
+
+static void report(const char *name, long long *lat, int n){
+	qsort(lat, n, sizeof(lat[0]), cmp_ll);
+	printf("%-10s %10d %12.2f %12.2f\n", name, n, lat[n / 2] / 1e3, lat[(long)n * 99 / 100] / 1e3);
+}
+
+/* 왕복 시간 / 2 를 한 방향 지연으로 본다 */
+static void bench_condvar(shm_region *r, int rounds, long long *lat){
+	shared_data *d = shm_data(r);
+	pid_t pid;
+
+	d->turn = 0;
+	if((pid = fork()) == 0){
+		for(int i = 0; i < rounds; i++){
+			shm_lock(r);
+			while(d->turn != 1)
+				shm_cond_wait(r);
+			d->msg[0] = 'x';    // memMapping.c 의 addr[0] = 'x'
+			d->turn = 0;
+			shm_cond_broadcast(r);
+			shm_unlock(r);
+		}
+		_exit(0);
+	}
+	for(int i = 0; i < rounds; i++){
+		long long t0 = now_ns();
+		shm_lock(r);
+		d->msg[1] = 'y';        // memMapping.c 의 addr[1] = 'y'
+		d->turn = 1;
+		shm_cond_broadcast(r);
+		while(d->turn != 0)
+			shm_cond_wait(r);
+		shm_unlock(r);
+		lat[i] = (now_ns() - t0) / 2;
+	}
+	waitpid(pid, NULL, 0);
+}
+
+static void bench_futex(shm_region *r, int rounds, long long *lat){
+	atomic_uint *w = &r->hdr->futex;
+	pid_t pid;
+
+	atomic_store(w, 0);
+	if((pid = fork()) == 0){
+		for(int i = 0; i < rounds; i++){
+			while(atomic_load(w) != 1)
+				shm_futex_wait(r, 0);
+			atomic_store(w, 0);
+			shm_futex_wake(r, 1);
+		}
+		_exit(0);
+	}
+	for(int i = 0; i < rounds; i++){
+		long long t0 = now_ns();
+		atomic_store(w, 1);
+		shm_futex_wake(r, 1);
+		while(atomic_load(w) != 0)
+			shm_futex_wait(r, 1);
+		lat[i] = (now_ns() - t0) / 2;
+	}
+	waitpid(pid, NULL, 0);
+}
+
+/* 자식이 쓰고 부모가 seqlock 으로 읽는다. 쓴 시각과 읽은 시각의 차가 지연 */
+static void bench_seqlock(shm_region *r, int rounds, long long *lat){
+	shared_data *d = shm_data(r);
+	pid_t pid;
+
+	d->round = -1;
+	atomic_store(&d->ack, -1);
+	if((pid = fork()) == 0){
+		for(long i = 0; i < rounds; i++){
+			while(atomic_load(&d->ack) != i - 1)
+				sched_yield();
+			shm_seq_write_begin(r);
+			snprintf(d->msg, sizeof(d->msg), "round %ld", i);
+			d->round = i;
+			d->stamp = now_ns();
+			shm_seq_write_end(r);
+		}
+		_exit(0);
+	}
+	for(long i = 0; i < rounds; i++){
+		long round, stamp;
+		for(;;){
+			unsigned s = shm_seq_read_begin(r);
+			round = d->round;
+			stamp = d->stamp;
+			if(!shm_seq_read_retry(r, s) && round == i)
+				break;
+			sched_yield();
+		}
+		lat[i] = now_ns() - stamp;
+		atomic_store(&d->ack, i);
+	}
+	waitpid(pid, NULL, 0);
+}
+
+/* memMapping.c 방식: 상대가 썼으리라 믿고 sleep(1) 뒤에 읽는다 */
+static void bench_sleep(shm_region *r, int rounds, long long *lat){
+	shared_data *d = shm_data(r);
+	pid_t pid;
+
+	d->stamp = 0;
+	if((pid = fork()) == 0){
+		for(int i = 0; i < rounds; i++){
+			d->stamp = now_ns();
+			d->msg[0] = 'x';
+			sleep(2);
+		}
+		_exit(0);
+	}
+	for(int i = 0; i < rounds; i++){
+		sleep(1);
+		lat[i] = now_ns() - d->stamp;
+		sleep(1);
+	}
+	waitpid(pid, NULL, 0);
+}
+
+int main(int argc, char *argv[]){
+	shm_region r;
+	int rounds = 100000, sleep_rounds = 2;
+	long long *lat;
+
+	if(argc > 1) rounds = atoi(argv[1]);
+	if(argc > 2) sleep_rounds = atoi(argv[2]);
+	if(rounds < 1 || sleep_rounds < 0){
+		fprintf(stderr, "Usage : %s [rounds] [sleep_rounds]\n", argv[0]);
+		exit(1);
+	}
+	if(shm_region_create(&r, NULL, sizeof(shared_data)) == -1){
+		perror("shm_region_create");
+		exit(1);
+	}
+	lat = malloc(sizeof(long long) * (rounds > sleep_rounds ? rounds : sleep_rounds));
+
+	printf("%-10s %10s %12s %12s\n", "method", "rounds", "p50(us)", "p99(us)");
+	bench_condvar(&r, rounds, lat);
+	report("condvar", lat, rounds);
+	bench_futex(&r, rounds, lat);
+	report("futex", lat, rounds);
+	bench_seqlock(&r, rounds, lat);
+	report("seqlock", lat, rounds);
+	if(sleep_rounds > 0){
+		bench_sleep(&r, sleep_rounds, lat);
+		report("sleep", lat, sleep_rounds);
+	}
+
+	free(lat);
+	shm_region_close(&r);
+	return 0;
+}
@@ -0,0 +1,120 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "zc_pipe.h"
+
+int zc_pipe_setsize(int fd, int size){
+	if(fcntl(fd, F_SETPIPE_SZ, size) == -1)
+		return -1;
+	return fcntl(fd, F_GETPIPE_SZ);
+}
+
+ssize_t zc_write_all(int fd, const void *buf, size_t len){
+	const char *p = buf;
+	size_t done = 0;
+
+	while(done < len){
+		ssize_t n = write(fd, p + done, len - done);
+		if(n == -1){
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		done += n;
+	}
+	return done;
+}
+
+ssize_t zc_read_all(int fd, void *buf, size_t len){
+	char *p = buf;
+	size_t done = 0;
+
+	while(done < len){
+		ssize_t n = read(fd, p + done, len - done);
+		if(n == -1){
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		if(n == 0)
+			break;
+		done += n;
+	}
+	return done;
+}
+
+ssize_t zc_vmsplice_all(int pipe_w, const void *buf, size_t len){
+	struct iovec iov;
+	size_t done = 0;
+
+	while(done < len){
+		ssize_t n;
+		iov.iov_base = (char *)buf + done;
+		iov.iov_len = len - done;
+		n = vmsplice(pipe_w, &iov, 1, 0);
+		if(n == -1){
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		done += n;
+	}
+	return done;
+}
+
+ssize_t zc_splice_all(int pipe_r, int out_fd, size_t len){
+	size_t done = 0;
+
+	while(done < len){
+		ssize_t n = splice(pipe_r, NULL, out_fd, NULL, len - done, SPLICE_F_MOVE|SPLICE_F_MORE);
+		if(n == -1){
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		if(n == 0)
+			break;
+		done += n;
+	}
+	return done;
+}
+
+ssize_t zc_tee(int pipe_r, int pipe_w, size_t len){
+	ssize_t n;
+
+	do{
+		n = tee(pipe_r, pipe_w, len, 0);
+	}while(n == -1 && errno == EINTR);
+	return n;
+}
+
+int zc_ring_init(zc_ring *r, size_t pipe_size){
+	r->chunk = pipe_size;
+	r->next = 0;
+	for(int i = 0; i < 2; i++){
+		// 페이지 정렬이어야 vmsplice 가 페이지를 통째로 참조한다
+		r->buf[i] = mmap(NULL, pipe_size, PROT_READ|PROT_WRITE,
+				MAP_PRIVATE|MAP_ANONYMOUS|MAP_POPULATE, -1, 0);
+		if(r->buf[i] == MAP_FAILED){
+			if(i == 1)
+				munmap(r->buf[0], pipe_size);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+void zc_ring_free(zc_ring *r){
+	munmap(r->buf[0], r->chunk);
+	munmap(r->buf[1], r->chunk);
+}
+
+char *zc_ring_next(zc_ring *r){
+	char *p = r->buf[r->next];
+	r->next ^= 1;
+	return p;
+}
@@ -0,0 +1,197 @@
+#define _GNU_SOURCE
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "zc_pipe.h"
+
+/* IPC_pipe.c 처럼 부모가 자식에게 파이프로 보내되, 복사 방식과 zero-copy 방식을 비교한다.
+ *   copy        : write() -> read()            (IPC_pipe.c 방식)
+ *   vmsplice    : vmsplice() -> read()         (보내는 쪽 복사 없음)
+ *   zero-copy   : vmsplice() -> splice(/dev/null)
+ *   tee fan-out : vmsplice() -> tee 로 두 번째 파이프에 복제 -> 둘 다 splice(/dev/null)
+ * 끝으로 버퍼를 바로 다시 쓰는 경우(hazard)와 zc_ring 을 쓰는 경우의 데이터 오염을 센다.
+ * 사용법: ./zc_pipe_bench [최대 전송 크기 MB(1024)] [파이프 크기(1MB)] */
+
+enum { M_COPY, M_VMSPLICE, M_ZEROCOPY, M_TEE, M_HAZARD, M_RING, M_COUNT };
+static const char *mode_name[] = { "copy", "vmsplice", "zero-copy", "tee fan-out", "hazard", "ring" };
+
+typedef struct {
+	int mode;
+	long long size;
+} request;
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 자식: 요청을 받을 때마다 size 바이트를 mode 대로 소비하고, 오염된 칸 수를 돌려준다 */
+static void receiver(int ctl_r, int data_r, int ack_w, size_t psize){
+	char *buf = malloc(psize);
+	int devnull = open("/dev/null", O_WRONLY);
+	int tp[2];
+	request rq;
+
+	pipe(tp);
+	zc_pipe_setsize(tp[0], psize);
+
+	while(read(ctl_r, &rq, sizeof(rq)) == sizeof(rq)){
+		long long left = rq.size;
+		long corrupt = 0, chunk_idx = 0;
+
+		while(left > 0){
+			size_t want = left < (long long)psize ? left : psize;
+			ssize_t n;
+
+			switch(rq.mode){
+			case M_ZEROCOPY:
+				n = zc_splice_all(data_r, devnull, want);
+				break;
+			case M_TEE:
+				// 한 번 복제한 양만큼 양쪽에서 빼낸다
+				n = zc_tee(data_r, tp[1], want);
+				if(n > 0){
+					zc_splice_all(data_r, devnull, n);
+					zc_splice_all(tp[0], devnull, n);
+				}
+				break;
+			default:
+				n = zc_read_all(data_r, buf, want);
+				if(rq.mode == M_HAZARD || rq.mode == M_RING){
+					for(ssize_t i = 0; i < n; i++){
+						if(buf[i] != (char)chunk_idx){
+							corrupt++;
+							break;
+						}
+					}
+					chunk_idx++;
+				}
+				break;
+			}
+			if(n <= 0)
+				_exit(1);
+			left -= n;
+		}
+		write(ack_w, &corrupt, sizeof(corrupt));
+	}
+	_exit(0);
+}
+
+static long send_one(int mode, long long size, int ctl_w, int data_w, int ack_r,
+		char *copybuf, zc_ring *ring, size_t psize){
+	request rq = { mode, size };
+	long long left = size;
+	long chunk_idx = 0, corrupt;
+
+	write(ctl_w, &rq, sizeof(rq));
+	while(left > 0){
+		size_t n = left < (long long)psize ? left : psize;
+		char *p;
+
+		switch(mode){
+		case M_COPY:
+			zc_write_all(data_w, copybuf, n);
+			break;
+		case M_HAZARD:
+			// 같은 버퍼를 보내자마자 다음 내용으로 덮어쓴다
+			memset(copybuf, (char)chunk_idx, n);
+			zc_vmsplice_all(data_w, copybuf, n);
+			memset(copybuf, 0x7f, n);
+			break;
+		case M_RING:
+			p = zc_ring_next(ring);
+			memset(p, (char)chunk_idx, n);
+			zc_vmsplice_all(data_w, p, n);
+			break;
+		default:
+			zc_vmsplice_all(data_w, zc_ring_next(ring), n);
+			break;
+		}
+		chunk_idx++;
+		left -= n;
+	}
+	read(ack_r, &corrupt, sizeof(corrupt));
+	return corrupt;
+}
+
+int main(int argc, char *argv[]){
+	long long max_mb = 1024;
+	int psize = 1 << 20;
+	int ctl[2], data[2], ack[2];
+	char *copybuf;
+	zc_ring ring;
+	pid_t pid;
+
+	if(argc > 1) max_mb = atoll(argv[1]);
+	if(argc > 2) psize = atoi(argv[2]);
+
+	pipe(ctl);
+	pipe(data);
+	pipe(ack);
+	if((psize = zc_pipe_setsize(data[1], psize)) == -1){
+		perror("F_SETPIPE_SZ");
+		exit(1);
+	}
+	if((pid = fork()) == 0){
+		close(ctl[1]);
+		close(data[1]);
+		close(ack[0]);
+		receiver(ctl[0], data[0], ack[1], psize);
+	}
+	close(ctl[0]);
+	close(data[0]);
+	close(ack[1]);
+
+	// 페이지 정렬 버퍼 (vmsplice 가 페이지 단위로 참조)
+	if(posix_memalign((void **)&copybuf, 4096, psize) != 0 || zc_ring_init(&ring, psize) == -1){
+		perror("alloc");
+		exit(1);
+	}
+	memset(copybuf, 'a', psize);
+	memset(ring.buf[0], 'a', psize);
+	memset(ring.buf[1], 'a', psize);
+
+	printf("pipe size %d\n", psize);
+	printf("%-12s", "size");
+	for(int m = 0; m < M_TEE + 1; m++)
+		printf(" %12s", mode_name[m]);
+	printf("   (MB/s)\n");
+
+	for(long long size = 4096; size <= max_mb * 1048576; size *= 4){
+		printf("%-12lld", size);
+		for(int m = 0; m <= M_TEE; m++){
+			// 작은 크기는 여러 번 반복해서 시간을 잰다
+			long reps = 0;
+			double t0 = now_sec(), dt;
+			do{
+				send_one(m, size, ctl[1], data[1], ack[0], copybuf, &ring, psize);
+				reps++;
+			}while((dt = now_sec() - t0) < 0.1 && reps < 100000);
+			printf(" %12.0f", size * (double)reps / dt / 1048576.0);
+		}
+		printf("\n");
+		fflush(stdout);
+	}
+
+	// 페이지 재사용 위험: 64 칸 보내서 오염된 칸 수
+	{
+		long long size = (long long)psize * 64;
+		printf("\npage reuse: %lld chunks\n", size / psize);
+		printf("  hazard (overwrite after vmsplice): %ld corrupted\n",
+				send_one(M_HAZARD, size, ctl[1], data[1], ack[0], copybuf, &ring, psize));
+		printf("  ring   (2 x pipe size buffers)   : %ld corrupted\n",
+				send_one(M_RING, size, ctl[1], data[1], ack[0], copybuf, &ring, psize));
+	}
+
+	close(ctl[1]);
+	close(data[1]);
+	waitpid(pid, NULL, 0);
+	zc_ring_free(&ring);
+	free(copybuf);
+	return 0;
+}
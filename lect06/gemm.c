@@ -0,0 +1,32 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gemm.h"
+
+#define MAX_THREADS 256
+
+/* 캐시 블록 크기 (원소 수). MC x KC 의 A 패널은 L2, KC x NC 의 B 패널은 L3 에 들어가도록 */
+#define MC 96
+#define KC 256
+#define NC 512
+#define MR 6        // 마이크로커널 행 수
+
+/* 벡터 폭: AVX 가 있으면 32 바이트, 아니면 SSE2 16 바이트 */
+#if defined(__AVX__)
+#define VEC_BYTES 32
+#else
+#define VEC_BYTES 16
+#endif
+
+#define REAL double
+#define SUFFIX d
+#include "gemm_impl.h"
+#undef REAL
+#undef SUFFIX
+
+#define REAL float
+#define SUFFIX s
+#include "gemm_impl.h"
+#undef REAL
+#undef SUFFIX
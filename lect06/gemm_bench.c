@@ -0,0 +1,114 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "gemm.h"
+
+/* Pthread.c 의 A/B/S 배열 계산을 행렬 곱으로 확장한 벤치마크.
+ * 64x64 부터 두 배씩 최대 크기까지 GFLOP/s 를 잰다. 단순 삼중 루프는 너무 느리므로
+ * naive_max 이하 크기에서만 돌리고, 그때 결과가 같은지도 확인한다.
+ * 사용법: ./gemm_bench [최대 크기(8192)] [스레드 수(CPU 수)] [naive_max(1024)] */
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* gemm 이 실패하면 (메모리 부족) 측정을 그만둔다 */
+static void must(int ret){
+    if(ret < 0){
+        fprintf(stderr, "gemm: out of memory\n");
+        exit(1);
+    }
+}
+
+static void *xmalloc(size_t size){
+    void *p = malloc(size);
+    if(p == NULL){
+        fprintf(stderr, "malloc %zu bytes: out of memory\n", size);
+        exit(1);
+    }
+    return p;
+}
+
+/* 측정이 너무 짧으면 여러 번 반복해서 평균 */
+#define MIN_SECONDS 0.2
+
+#define BENCH(call, n, out_gflops) do {                           \
+        int reps = 0;                                             \
+        double t0 = now_sec(), t;                                 \
+        do { call; reps++; } while((t = now_sec() - t0) < MIN_SECONDS); \
+        out_gflops = 2.0 * (n) * (n) * (double)(n) * reps / t / 1e9; \
+    } while(0)
+
+static void run_double(int n, int nthreads, int naive_max){
+    size_t sz = (size_t)n * n;
+    double *A = xmalloc(sizeof(double) * sz), *B = xmalloc(sizeof(double) * sz);
+    double *S = xmalloc(sizeof(double) * sz), *R = NULL;
+    double tiled, naive = 0, err = 0;
+
+    for(size_t i = 0; i < sz; i++){
+        A[i] = (double)(i % 17) - 8;
+        B[i] = (double)(i % 13) / 7.0;
+    }
+    BENCH(must(gemm_d(n, n, n, A, n, B, n, S, n, nthreads)), n, tiled);
+    if(n <= naive_max){
+        R = xmalloc(sizeof(double) * sz);     // 비교할 때만 필요하다
+        BENCH(gemm_naive_d(n, n, n, A, n, B, n, R, n), n, naive);
+        for(size_t i = 0; i < sz; i++)
+            err = fmax(err, fabs(S[i] - R[i]) / (fabs(R[i]) + 1));
+        printf("double %6d %12.2f %12.2f %10.1fx %10.1e\n", n, tiled, naive, tiled / naive, err);
+    } else {
+        printf("double %6d %12.2f %12s %11s %10s\n", n, tiled, "-", "-", "-");
+    }
+    free(A); free(B); free(S); free(R);
+}
+
+static void run_float(int n, int nthreads, int naive_max){
+    size_t sz = (size_t)n * n;
+    float *A = xmalloc(sizeof(float) * sz), *B = xmalloc(sizeof(float) * sz);
+    float *S = xmalloc(sizeof(float) * sz), *R = NULL;
+    double tiled, naive = 0, err = 0;
+
+    for(size_t i = 0; i < sz; i++){
+        A[i] = (float)(i % 17) - 8;
+        B[i] = (float)(i % 13) / 7.0f;
+    }
+    BENCH(must(gemm_s(n, n, n, A, n, B, n, S, n, nthreads)), n, tiled);
+    if(n <= naive_max){
+        R = xmalloc(sizeof(float) * sz);
+        BENCH(gemm_naive_s(n, n, n, A, n, B, n, R, n), n, naive);
+        for(size_t i = 0; i < sz; i++)
+            err = fmax(err, fabs(S[i] - R[i]) / (fabs(R[i]) + 1));
+        printf("float  %6d %12.2f %12.2f %10.1fx %10.1e\n", n, tiled, naive, tiled / naive, err);
+    } else {
+        printf("float  %6d %12.2f %12s %11s %10s\n", n, tiled, "-", "-", "-");
+    }
+    free(A); free(B); free(S); free(R);
+}
+
+int main(int argc, char *argv[]){
+    int max_n = 8192;
+    int nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    int naive_max = 1024;
+
+    if(argc > 1) max_n = atoi(argv[1]);
+    if(argc > 2) nthreads = atoi(argv[2]);
+    if(argc > 3) naive_max = atoi(argv[3]);
+    if(max_n < 64 || nthreads < 1){
+        fprintf(stderr, "Usage : %s [max_n] [threads] [naive_max]\n", argv[0]);
+        exit(1);
+    }
+
+    printf("threads = %d\n", nthreads);
+    printf("%-6s %6s %12s %12s %11s %10s\n", "type", "n", "tiled GF/s", "naive GF/s", "speedup", "max err");
+    for(int n = 64; n <= max_n; n *= 2){
+        run_double(n, nthreads, naive_max);
+        run_float(n, nthreads, naive_max);
+    }
+
+    return 0;
+}
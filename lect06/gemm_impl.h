@@ -0,0 +1,200 @@
+/* gemm.c 에서 REAL/SUFFIX 를 바꿔 가며 두 번 include 한다 (double, float).
+ *
+ * 구조 (Goto 방식):
+ *   C 를 MC x NC 타일로 나누고 스레드가 타일을 하나씩 가져간다.
+ *   타일 안에서 K 를 KC 씩 잘라 B(KC x NC) 와 A(MC x KC) 를 연속 메모리로 패킹한 뒤
+ *   MR x NR 레지스터 블록 마이크로커널을 돌린다. */
+
+#define CAT_(a, b) a##b
+#define CAT(a, b) CAT_(a, b)
+#define FN(name) CAT(name, SUFFIX)
+
+#define VLEN (VEC_BYTES / (int)sizeof(REAL))
+#define NR (2 * VLEN)
+
+typedef REAL FN(vec_) __attribute__((vector_size(VEC_BYTES), aligned(sizeof(REAL))));
+
+typedef struct {
+    int M, N, K;
+    const REAL *A;
+    int lda;
+    const REAL *B;
+    int ldb;
+    REAL *C;
+    int ldc;
+    int tiles_m, tiles_n;
+    atomic_int next_tile;
+} FN(gemm_job_);
+
+/* A 의 mc x kc 블록을 MR 행 띠로 패킹: 띠마다 [k][MR] */
+static void FN(pack_a_)(int mc, int kc, const REAL *A, int lda, REAL *Ap){
+    for(int i = 0; i < mc; i += MR){
+        int rows = mc - i < MR ? mc - i : MR;
+        for(int p = 0; p < kc; p++){
+            int r;
+            for(r = 0; r < rows; r++)
+                *Ap++ = A[(i + r) * lda + p];
+            for(; r < MR; r++)
+                *Ap++ = 0;
+        }
+    }
+}
+
+/* B 의 kc x nc 블록을 NR 열 띠로 패킹: 띠마다 [k][NR] */
+static void FN(pack_b_)(int kc, int nc, const REAL *B, int ldb, REAL *Bp){
+    for(int j = 0; j < nc; j += NR){
+        int cols = nc - j < NR ? nc - j : NR;
+        for(int p = 0; p < kc; p++){
+            const REAL *b = B + p * ldb + j;
+            int c;
+            for(c = 0; c < cols; c++)
+                *Bp++ = b[c];
+            for(; c < NR; c++)
+                *Bp++ = 0;
+        }
+    }
+}
+
+/* MR x NR 블록을 레지스터에 두고 kc 번 rank-1 갱신 */
+static void FN(micro_kernel_)(int kc, const REAL *Ap, const REAL *Bp,
+                              REAL *C, int ldc, int rows, int cols){
+    FN(vec_) c0[MR], c1[MR];
+
+    for(int i = 0; i < MR; i++){
+        c0[i] = (FN(vec_)){ 0 };
+        c1[i] = (FN(vec_)){ 0 };
+    }
+    for(int p = 0; p < kc; p++){
+        FN(vec_) b0 = *(const FN(vec_) *)(Bp);
+        FN(vec_) b1 = *(const FN(vec_) *)(Bp + VLEN);
+        for(int i = 0; i < MR; i++){
+            REAL a = Ap[i];
+            c0[i] += a * b0;
+            c1[i] += a * b1;
+        }
+        Ap += MR;
+        Bp += NR;
+    }
+
+    if(rows == MR && cols == NR){
+        for(int i = 0; i < MR; i++){
+            REAL *c = C + i * ldc;
+            for(int j = 0; j < VLEN; j++){
+                c[j] += c0[i][j];
+                c[VLEN + j] += c1[i][j];
+            }
+        }
+    } else {
+        // 가장자리: 필요한 부분만 더한다
+        for(int i = 0; i < rows; i++){
+            REAL *c = C + i * ldc;
+            for(int j = 0; j < cols; j++)
+                c[j] += j < VLEN ? c0[i][j] : c1[i][j - VLEN];
+        }
+    }
+}
+
+/* 워커 하나의 인자. 패킹 버퍼는 워커를 띄우기 전에 잡아 둔다 */
+typedef struct {
+    FN(gemm_job_) *job;
+    REAL *Ap, *Bp;
+} FN(gemm_arg_);
+
+static void *FN(gemm_worker_)(void *argument){
+    FN(gemm_arg_) *arg = argument;
+    FN(gemm_job_) *job = arg->job;
+    REAL *Ap = arg->Ap, *Bp = arg->Bp;
+    int ntiles = job->tiles_m * job->tiles_n;
+    int t;
+
+    while((t = atomic_fetch_add(&job->next_tile, 1)) < ntiles){
+        int ic = (t / job->tiles_n) * MC;
+        int jc = (t % job->tiles_n) * NC;
+        int mc = job->M - ic < MC ? job->M - ic : MC;
+        int nc = job->N - jc < NC ? job->N - jc : NC;
+
+        for(int pc = 0; pc < job->K; pc += KC){
+            int kc = job->K - pc < KC ? job->K - pc : KC;
+
+            FN(pack_b_)(kc, nc, job->B + pc * job->ldb + jc, job->ldb, Bp);
+            FN(pack_a_)(mc, kc, job->A + ic * job->lda + pc, job->lda, Ap);
+
+            for(int jr = 0; jr < nc; jr += NR){
+                int cols = nc - jr < NR ? nc - jr : NR;
+                for(int ir = 0; ir < mc; ir += MR){
+                    int rows = mc - ir < MR ? mc - ir : MR;
+                    FN(micro_kernel_)(kc, Ap + ir * kc, Bp + jr * kc,
+                                      job->C + (ic + ir) * job->ldc + jc + jr,
+                                      job->ldc, rows, cols);
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+int FN(gemm_)(int M, int N, int K, const REAL *A, int lda,
+              const REAL *B, int ldb, REAL *C, int ldc, int nthreads){
+    FN(gemm_job_) job = { M, N, K, A, lda, B, ldb, C, ldc,
+                          (M + MC - 1) / MC, (N + NC - 1) / NC };
+    FN(gemm_arg_) args[MAX_THREADS] = { { 0 } };
+    pthread_t threads[MAX_THREADS];
+    int created[MAX_THREADS] = { 0 };
+    int ret = 0;
+
+    for(int i = 0; i < M; i++)
+        memset(C + i * ldc, 0, sizeof(REAL) * N);
+    if(M <= 0 || N <= 0 || K <= 0)
+        return 0;
+
+    atomic_init(&job.next_tile, 0);
+    if(nthreads < 1)
+        nthreads = 1;
+    if(nthreads > MAX_THREADS)
+        nthreads = MAX_THREADS;
+    if(nthreads > job.tiles_m * job.tiles_n)
+        nthreads = job.tiles_m * job.tiles_n;
+
+    // 버퍼를 하나라도 못 잡으면 계산을 시작하지 않고 실패를 돌려준다
+    for(int i = 0; i < nthreads; i++){
+        args[i].job = &job;
+        if(posix_memalign((void **)&args[i].Ap, 64, sizeof(REAL) * (MC + MR) * KC) != 0 ||
+           posix_memalign((void **)&args[i].Bp, 64, sizeof(REAL) * KC * (NC + NR)) != 0){
+            ret = -1;
+            goto out;
+        }
+    }
+
+    // 호출한 스레드도 워커로 일한다. 스레드를 못 띄우면 남은 타일은 나머지가 가져간다
+    for(int i = 1; i < nthreads; i++)
+        created[i] = pthread_create(&threads[i], NULL, FN(gemm_worker_), &args[i]) == 0;
+    FN(gemm_worker_)(&args[0]);
+    for(int i = 1; i < nthreads; i++)
+        if(created[i])
+            pthread_join(threads[i], NULL);
+
+out:
+    for(int i = 0; i < nthreads; i++){
+        free(args[i].Ap);
+        free(args[i].Bp);
+    }
+    return ret;
+}
+
+void FN(gemm_naive_)(int M, int N, int K, const REAL *A, int lda,
+                     const REAL *B, int ldb, REAL *C, int ldc){
+    for(int i = 0; i < M; i++){
+        for(int j = 0; j < N; j++){
+            REAL s = 0;
+            for(int p = 0; p < K; p++)
+                s += A[i * lda + p] * B[p * ldb + j];
+            C[i * ldc + j] = s;
+        }
+    }
+}
+
+#undef VLEN
+#undef NR
+#undef FN
+#undef CAT
+#undef CAT_
@@ -0,0 +1,19 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+/* 행 우선(row-major) 밀집 행렬 곱: C = A * B
+ * A 는 M x K, B 는 K x N, C 는 M x N. lda/ldb/ldc 는 한 행의 원소 수.
+ * nthreads 개의 스레드가 C 의 출력 타일을 나눠서 계산한다.
+ * 성공하면 0, 패킹 버퍼를 잡지 못하면 -1 (C 는 0 으로 채워진 채 남는다). */
+int gemm_d(int M, int N, int K, const double *A, int lda,
+           const double *B, int ldb, double *C, int ldc, int nthreads);
+int gemm_s(int M, int N, int K, const float *A, int lda,
+           const float *B, int ldb, float *C, int ldc, int nthreads);
+
+/* 비교용 단순 삼중 루프 */
+void gemm_naive_d(int M, int N, int K, const double *A, int lda,
+                  const double *B, int ldb, double *C, int ldc);
+void gemm_naive_s(int M, int N, int K, const float *A, int lda,
+                  const float *B, int ldb, float *C, int ldc);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stdatomic.h>
+
+/* 작업 함수: Pthread.c 의 TaskCode 와 같은 모양 */
+typedef void *(*tp_func)(void *argument);
+
+/* 한 작업의 결과를 기다리는 future */
+typedef struct {
+    atomic_uint state;      // 0: 대기, 1: 완료, 2: 대기 + 잠든 waiter 있음
+    void *result;
+} tp_future;
+
+/* 여러 작업을 묶어서 한 번에 기다리는 완료 카운터 */
+typedef struct {
+    atomic_uint pending;    // 아직 끝나지 않은 작업 수
+    atomic_uint waiters;    // 잠든 waiter 가 있으면 1
+} tp_batch;
+
+typedef struct threadpool threadpool;
+
+/* nthreads 개의 워커와 qcap(2의 거듭제곱으로 올림) 칸짜리 큐를 가진 풀 생성 */
+threadpool *tp_create(int nthreads, unsigned qcap);
+/* 큐에 남은 작업을 모두 처리한 뒤 워커를 join 하고 해제 */
+void tp_destroy(threadpool *tp);
+
+/* 큐가 가득 차면 -1, 성공하면 0. fut/batch 는 NULL 이어도 됨 */
+int tp_try_submit(threadpool *tp, tp_func fn, void *arg, tp_future *fut, tp_batch *batch);
+/* 큐에 자리가 날 때까지 양보하며 재시도 */
+void tp_submit(threadpool *tp, tp_func fn, void *arg, tp_future *fut, tp_batch *batch);
+
+void tp_future_init(tp_future *f);
+void *tp_future_get(tp_future *f);
+
+void tp_batch_init(tp_batch *b);
+void tp_batch_wait(tp_batch *b);
+
+#endif
@@ -0,0 +1,252 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sched.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "threadpool.h"
+
+#define CACHE_LINE 64
+#define SPIN_BEFORE_PARK 256   // 잠들기 전에 큐를 다시 확인하는 횟수
+
+/* 큐 한 칸: seq 로 생산자/소비자 차례를 구분 (Vyukov bounded MPMC) */
+typedef struct {
+    atomic_size_t seq;
+    tp_func fn;
+    void *arg;
+    tp_future *fut;
+    tp_batch *batch;
+} tp_cell;
+
+struct threadpool {
+    tp_cell *cells;
+    size_t mask;
+    _Alignas(CACHE_LINE) atomic_size_t head;   // 생산자 위치
+    _Alignas(CACHE_LINE) atomic_size_t tail;   // 소비자 위치
+    _Alignas(CACHE_LINE) atomic_uint work_seq; // 워커가 futex 로 잠드는 워드
+    atomic_int sleepers;
+    atomic_int stop;
+    int nthreads;
+    pthread_t *threads;
+};
+
+static void futex_wait(atomic_uint *addr, unsigned val){
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint *addr, int n){
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+static int queue_push(threadpool *tp, tp_func fn, void *arg, tp_future *fut, tp_batch *batch){
+    tp_cell *c;
+    size_t pos = atomic_load_explicit(&tp->head, memory_order_relaxed);
+
+    for(;;){
+        c = &tp->cells[pos & tp->mask];
+        size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if(diff == 0){
+            if(atomic_compare_exchange_weak_explicit(&tp->head, &pos, pos + 1,
+                        memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if(diff < 0){
+            return -1;      // 가득 참
+        } else {
+            pos = atomic_load_explicit(&tp->head, memory_order_relaxed);
+        }
+    }
+
+    c->fn = fn;
+    c->arg = arg;
+    c->fut = fut;
+    c->batch = batch;
+    atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+    return 0;
+}
+
+static int queue_pop(threadpool *tp, tp_cell *out){
+    tp_cell *c;
+    size_t pos = atomic_load_explicit(&tp->tail, memory_order_relaxed);
+
+    for(;;){
+        c = &tp->cells[pos & tp->mask];
+        size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if(diff == 0){
+            if(atomic_compare_exchange_weak_explicit(&tp->tail, &pos, pos + 1,
+                        memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if(diff < 0){
+            return -1;      // 비어 있음
+        } else {
+            pos = atomic_load_explicit(&tp->tail, memory_order_relaxed);
+        }
+    }
+
+    out->fn = c->fn;
+    out->arg = c->arg;
+    out->fut = c->fut;
+    out->batch = c->batch;
+    atomic_store_explicit(&c->seq, pos + tp->mask + 1, memory_order_release);
+    return 0;
+}
+
+static void run_task(tp_cell *t){
+    void *res = t->fn(t->arg);
+
+    if(t->fut != NULL){
+        t->fut->result = res;
+        if(atomic_exchange(&t->fut->state, 1) == 2)
+            futex_wake(&t->fut->state, INT32_MAX);
+    }
+    if(t->batch != NULL){
+        if(atomic_fetch_sub(&t->batch->pending, 1) == 1 &&
+                atomic_load(&t->batch->waiters))
+            futex_wake(&t->batch->pending, INT32_MAX);
+    }
+}
+
+static void *worker(void *argument){
+    threadpool *tp = argument;
+    tp_cell t;
+
+    for(;;){
+        int spins;
+        for(spins = 0; spins < SPIN_BEFORE_PARK; spins++){
+            if(queue_pop(tp, &t) == 0)
+                break;
+        }
+        if(spins < SPIN_BEFORE_PARK){
+            run_task(&t);
+            continue;
+        }
+
+        // 큐가 비었으면 work_seq 를 먼저 읽고, sleepers 를 올린 뒤 한 번 더 확인
+        unsigned seq = atomic_load(&tp->work_seq);
+        atomic_fetch_add(&tp->sleepers, 1);
+        if(queue_pop(tp, &t) == 0){
+            atomic_fetch_sub(&tp->sleepers, 1);
+            run_task(&t);
+            continue;
+        }
+        if(atomic_load(&tp->stop)){
+            atomic_fetch_sub(&tp->sleepers, 1);
+            break;
+        }
+        futex_wait(&tp->work_seq, seq);
+        atomic_fetch_sub(&tp->sleepers, 1);
+    }
+    return NULL;
+}
+
+static void wake_workers(threadpool *tp, int n){
+    atomic_fetch_add(&tp->work_seq, 1);
+    if(atomic_load(&tp->sleepers) > 0)
+        futex_wake(&tp->work_seq, n);
+}
+
+threadpool *tp_create(int nthreads, unsigned qcap){
+    threadpool *tp;
+    size_t cap = 2;
+    int i;
+
+    if(nthreads < 1)
+        return NULL;
+    while(cap < qcap)
+        cap <<= 1;
+
+    if(posix_memalign((void **)&tp, CACHE_LINE, sizeof(*tp)) != 0)
+        return NULL;
+    tp->cells = calloc(cap, sizeof(tp_cell));
+    tp->threads = calloc(nthreads, sizeof(pthread_t));
+    if(tp->cells == NULL || tp->threads == NULL){
+        free(tp->cells);
+        free(tp->threads);
+        free(tp);
+        return NULL;
+    }
+    for(size_t k = 0; k < cap; k++)
+        atomic_init(&tp->cells[k].seq, k);
+    tp->mask = cap - 1;
+    atomic_init(&tp->head, 0);
+    atomic_init(&tp->tail, 0);
+    atomic_init(&tp->work_seq, 0);
+    atomic_init(&tp->sleepers, 0);
+    atomic_init(&tp->stop, 0);
+    tp->nthreads = nthreads;
+
+    for(i = 0; i < nthreads; i++){
+        if(pthread_create(&tp->threads[i], NULL, worker, tp) != 0){
+            perror("pthread_create");
+            tp->nthreads = i;
+            tp_destroy(tp);
+            return NULL;
+        }
+    }
+    return tp;
+}
+
+void tp_destroy(threadpool *tp){
+    atomic_store(&tp->stop, 1);
+    wake_workers(tp, INT32_MAX);
+    for(int i = 0; i < tp->nthreads; i++)
+        pthread_join(tp->threads[i], NULL);
+    free(tp->cells);
+    free(tp->threads);
+    free(tp);
+}
+
+int tp_try_submit(threadpool *tp, tp_func fn, void *arg, tp_future *fut, tp_batch *batch){
+    if(batch != NULL)
+        atomic_fetch_add(&batch->pending, 1);
+    if(queue_push(tp, fn, arg, fut, batch) != 0){
+        if(batch != NULL)
+            atomic_fetch_sub(&batch->pending, 1);
+        return -1;
+    }
+    wake_workers(tp, 1);
+    return 0;
+}
+
+void tp_submit(threadpool *tp, tp_func fn, void *arg, tp_future *fut, tp_batch *batch){
+    while(tp_try_submit(tp, fn, arg, fut, batch) != 0)
+        sched_yield();
+}
+
+void tp_future_init(tp_future *f){
+    atomic_init(&f->state, 0);
+    f->result = NULL;
+}
+
+void *tp_future_get(tp_future *f){
+    unsigned s;
+
+    while((s = atomic_load(&f->state)) != 1){
+        if(s == 0 && !atomic_compare_exchange_strong(&f->state, &s, 2))
+            continue;
+        futex_wait(&f->state, 2);
+    }
+    return f->result;
+}
+
+void tp_batch_init(tp_batch *b){
+    atomic_init(&b->pending, 0);
+    atomic_init(&b->waiters, 0);
+}
+
+void tp_batch_wait(tp_batch *b){
+    unsigned p;
+
+    while((p = atomic_load(&b->pending)) != 0){
+        atomic_store(&b->waiters, 1);
+        // waiters 를 올린 뒤 값이 그대로일 때만 잠든다
+        futex_wait(&b->pending, p);
+    }
+    atomic_store(&b->waiters, 0);
+}
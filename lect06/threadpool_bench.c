@@ -0,0 +1,156 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "threadpool.h"
+
+/* 스레드 풀 vs 작업마다 pthread_create/join 비교
+ * 사용법: ./threadpool_bench [최대 스레드 수(64)] [작업 수(200000)] */
+
+#define LAT_SAMPLES 4096
+
+static long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* 기준선이 틀어지지 않도록 스레드를 못 만들면 (RLIMIT_NPROC 등) 측정을 그만둔다 */
+static void create_failed(int err){
+    fprintf(stderr, "pthread_create: %s\n", strerror(err));
+    exit(1);
+}
+
+static int cmp_ll(const void *a, const void *b){
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+/* Pthread.c 처럼 아주 짧은 작업. 여러 스레드가 같은 카운터를 올리므로 atomic 으로 */
+static void *short_task(void *argument){
+    atomic_int *p = argument;
+    atomic_fetch_add_explicit(p, 1, memory_order_relaxed);
+    return NULL;
+}
+
+typedef struct {
+    long long submit_ns;
+    long long start_ns;
+} lat_slot;
+
+static void *latency_task(void *argument){
+    lat_slot *s = argument;
+    s->start_ns = now_ns();
+    return NULL;
+}
+
+static double bench_pool_throughput(threadpool *tp, int ntasks){
+    tp_batch b;
+    atomic_int dummy = 0;
+    long long t0;
+
+    tp_batch_init(&b);
+    t0 = now_ns();
+    for(int i = 0; i < ntasks; i++)
+        tp_submit(tp, short_task, &dummy, NULL, &b);
+    tp_batch_wait(&b);
+    return ntasks / ((now_ns() - t0) / 1e9);
+}
+
+/* 작업 하나를 넣고 시작될 때까지의 지연 (큐가 비어 있을 때) */
+static void bench_pool_latency(threadpool *tp, double *p50, double *p99){
+    static lat_slot slots[LAT_SAMPLES];
+    static long long lat[LAT_SAMPLES];
+    tp_future f;
+
+    for(int i = 0; i < LAT_SAMPLES; i++){
+        tp_future_init(&f);
+        slots[i].submit_ns = now_ns();
+        tp_submit(tp, latency_task, &slots[i], &f, NULL);
+        tp_future_get(&f);
+        lat[i] = slots[i].start_ns - slots[i].submit_ns;
+    }
+    qsort(lat, LAT_SAMPLES, sizeof(lat[0]), cmp_ll);
+    *p50 = lat[LAT_SAMPLES / 2] / 1e3;
+    *p99 = lat[LAT_SAMPLES * 99 / 100] / 1e3;
+}
+
+/* 기존 방식: nthreads 개씩 만들고 join 하는 것을 반복 */
+static double bench_create_throughput(int nthreads, int ntasks){
+    pthread_t *threads = malloc(sizeof(pthread_t) * nthreads);
+    atomic_int dummy = 0;
+    int done = 0;
+    long long t0 = now_ns();
+
+    while(done < ntasks){
+        int n = ntasks - done < nthreads ? ntasks - done : nthreads;
+        int err = 0, created;
+        for(created = 0; created < n; created++)
+            if((err = pthread_create(&threads[created], NULL, short_task, &dummy)) != 0)
+                break;
+        for(int i = 0; i < created; i++)
+            pthread_join(threads[i], NULL);
+        if(err)
+            create_failed(err);
+        done += n;
+    }
+    free(threads);
+    return ntasks / ((now_ns() - t0) / 1e9);
+}
+
+static void bench_create_latency(double *p50, double *p99){
+    static long long lat[LAT_SAMPLES];
+    lat_slot s;
+    pthread_t th;
+    int err;
+
+    for(int i = 0; i < LAT_SAMPLES; i++){
+        s.submit_ns = now_ns();
+        if((err = pthread_create(&th, NULL, latency_task, &s)) != 0)
+            create_failed(err);
+        pthread_join(th, NULL);
+        lat[i] = s.start_ns - s.submit_ns;
+    }
+    qsort(lat, LAT_SAMPLES, sizeof(lat[0]), cmp_ll);
+    *p50 = lat[LAT_SAMPLES / 2] / 1e3;
+    *p99 = lat[LAT_SAMPLES * 99 / 100] / 1e3;
+}
+
+int main(int argc, char *argv[]){
+    int max_threads = 64;
+    int ntasks = 200000;
+    double c50, c99;
+
+    if(argc > 1) max_threads = atoi(argv[1]);
+    if(argc > 2) ntasks = atoi(argv[2]);
+    if(max_threads < 1 || ntasks < 1){
+        fprintf(stderr, "Usage : %s [max_threads] [tasks]\n", argv[0]);
+        exit(1);
+    }
+
+    bench_create_latency(&c50, &c99);
+    printf("create-per-task latency: p50 %.2f us, p99 %.2f us\n\n", c50, c99);
+
+    printf("%8s %16s %16s %12s %12s\n",
+           "threads", "pool tasks/s", "create tasks/s", "p50(us)", "p99(us)");
+    for(int n = 1; n <= max_threads; n *= 2){
+        threadpool *tp = tp_create(n, 4096);
+        double p50, p99;
+
+        if(tp == NULL){
+            fprintf(stderr, "tp_create failed\n");
+            exit(1);
+        }
+        double pool = bench_pool_throughput(tp, ntasks);
+        bench_pool_latency(tp, &p50, &p99);
+        tp_destroy(tp);
+
+        double create = bench_create_throughput(n, ntasks / 10 > 0 ? ntasks / 10 : 1);
+        printf("%8d %16.0f %16.0f %12.2f %12.2f\n", n, pool, create, p50, p99);
+    }
+
+    return 0;
+}
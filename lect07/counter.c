@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "counter.h"
+
+int counter_init(counter_t *c, counter_kind kind, int nslots){
+    memset(c, 0, sizeof(*c));
+    c->kind = kind;
+    c->nslots = nslots > 0 ? nslots : 1;
+    pthread_mutex_init(&c->mtx, NULL);
+    atomic_init(&c->single, 0);
+
+    switch(kind){
+    case COUNTER_SLOTS:
+    case COUNTER_SHARDED:
+        if(posix_memalign((void **)&c->slots, CACHE_LINE,
+                    sizeof(counter_slot) * c->nslots) != 0)
+            return -1;
+        for(int i = 0; i < c->nslots; i++)
+            atomic_init(&c->slots[i].v, 0);
+        break;
+    case COUNTER_PACKED:
+        c->packed = calloc(c->nslots, sizeof(atomic_long));
+        if(c->packed == NULL)
+            return -1;
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+void counter_destroy(counter_t *c){
+    pthread_mutex_destroy(&c->mtx);
+    free(c->slots);
+    free(c->packed);
+}
+
+void counter_add(counter_t *c, int tid, long delta){
+    switch(c->kind){
+    case COUNTER_MUTEX:
+        pthread_mutex_lock(&c->mtx);
+        c->plain += delta;
+        pthread_mutex_unlock(&c->mtx);
+        break;
+    case COUNTER_ATOMIC:
+        atomic_fetch_add_explicit(&c->single, delta, memory_order_relaxed);
+        break;
+    case COUNTER_SLOTS: {
+        // 슬롯은 한 스레드만 쓰므로 lock 접두어 없이 load/store
+        atomic_long *v = &c->slots[tid % c->nslots].v;
+        atomic_store_explicit(v, atomic_load_explicit(v, memory_order_relaxed) + delta,
+                              memory_order_relaxed);
+        break;
+    }
+    case COUNTER_PACKED: {
+        atomic_long *v = &c->packed[tid % c->nslots];
+        atomic_store_explicit(v, atomic_load_explicit(v, memory_order_relaxed) + delta,
+                              memory_order_relaxed);
+        break;
+    }
+    case COUNTER_SHARDED:
+        atomic_fetch_add_explicit(&c->slots[tid % c->nslots].v, delta, memory_order_relaxed);
+        break;
+    }
+}
+
+long counter_read(counter_t *c){
+    long sum = 0;
+
+    switch(c->kind){
+    case COUNTER_MUTEX:
+        pthread_mutex_lock(&c->mtx);
+        sum = c->plain;
+        pthread_mutex_unlock(&c->mtx);
+        break;
+    case COUNTER_ATOMIC:
+        sum = atomic_load(&c->single);
+        break;
+    case COUNTER_SLOTS:
+    case COUNTER_SHARDED:
+        for(int i = 0; i < c->nslots; i++)
+            sum += atomic_load_explicit(&c->slots[i].v, memory_order_relaxed);
+        break;
+    case COUNTER_PACKED:
+        for(int i = 0; i < c->nslots; i++)
+            sum += atomic_load_explicit(&c->packed[i], memory_order_relaxed);
+        break;
+    }
+    return sum;
+}
+
+const char *counter_name(counter_kind kind){
+    switch(kind){
+    case COUNTER_MUTEX:   return "mutex";
+    case COUNTER_ATOMIC:  return "atomic";
+    case COUNTER_SLOTS:   return "padded-slots";
+    case COUNTER_PACKED:  return "packed-slots";
+    case COUNTER_SHARDED: return "sharded";
+    }
+    return "?";
+}
@@ -0,0 +1,121 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "counter.h"
+
+/* Pthread.c 의 acc 누적을 방식별로 비교한다.
+ * final : 스레드마다 부분합을 만든 뒤 한 번만 더함 (Pthread.c 방식)
+ * iter  : 반복마다 한 번씩 더함
+ * 사용법: ./counter_bench [최대 스레드 수(64)] [스레드당 반복(1000000)] */
+
+#define NUM_SHARDS 16
+
+typedef struct {
+    counter_t *c;
+    int tid;
+    long iters;
+    int per_iter;
+} bench_arg;
+
+static pthread_barrier_t start_barrier;
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void *TaskCode(void *argument){
+    bench_arg *a = argument;
+
+    pthread_barrier_wait(&start_barrier);
+    if(a->per_iter){
+        for(long i = 0; i < a->iters; i++)
+            counter_add(a->c, a->tid, 1);
+    } else {
+        volatile long partial_acc = 0;
+        for(long i = 0; i < a->iters; i++)
+            partial_acc++;
+        counter_reduce(a->c, a->tid, partial_acc);
+    }
+    return NULL;
+}
+
+/* ops/sec 를 돌려준다. 결과가 틀리면 종료 */
+static double run(counter_kind kind, int nthreads, long iters, int per_iter){
+    pthread_t threads[nthreads];
+    bench_arg args[nthreads];
+    counter_t c;
+    double t0, t1;
+
+    if(counter_init(&c, kind, kind == COUNTER_SHARDED ? NUM_SHARDS : nthreads) != 0){
+        fprintf(stderr, "counter_init failed\n");
+        exit(1);
+    }
+    pthread_barrier_init(&start_barrier, NULL, nthreads + 1);
+    for(int i = 0; i < nthreads; i++){
+        args[i] = (bench_arg){ &c, i, iters, per_iter };
+        pthread_create(&threads[i], NULL, TaskCode, &args[i]);
+    }
+    t0 = now_sec();
+    pthread_barrier_wait(&start_barrier);
+    for(int i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+    t1 = now_sec();
+    pthread_barrier_destroy(&start_barrier);
+
+    if(counter_read(&c) != iters * nthreads){
+        fprintf(stderr, "%s: wrong sum %ld\n", counter_name(kind), counter_read(&c));
+        exit(1);
+    }
+    counter_destroy(&c);
+    return (double)iters * nthreads / (t1 - t0);
+}
+
+int main(int argc, char *argv[]){
+    int max_threads = 64;
+    long iters = 1000000;
+    counter_kind kinds[] = { COUNTER_MUTEX, COUNTER_ATOMIC, COUNTER_SLOTS,
+                             COUNTER_PACKED, COUNTER_SHARDED };
+    int nkinds = sizeof(kinds) / sizeof(kinds[0]);
+
+    if(argc > 1) max_threads = atoi(argv[1]);
+    if(argc > 2) iters = atol(argv[2]);
+    if(max_threads < 1 || iters < 1){
+        fprintf(stderr, "Usage : %s [max_threads] [iters]\n", argv[0]);
+        exit(1);
+    }
+
+    for(int per_iter = 0; per_iter <= 1; per_iter++){
+        printf("== %s ==\n", per_iter ? "add per iteration" : "one final add per thread");
+        printf("%8s", "threads");
+        for(int k = 0; k < nkinds; k++)
+            printf(" %14s", counter_name(kinds[k]));
+        printf("   (Mops/s)\n");
+
+        double base[nkinds];
+        for(int n = 1; n <= max_threads; n *= 2){
+            printf("%8d", n);
+            for(int k = 0; k < nkinds; k++){
+                double ops = run(kinds[k], n, iters, per_iter);
+                if(n == 1) base[k] = ops;
+                printf(" %14.1f", ops / 1e6);
+            }
+            printf("\n");
+        }
+
+        // 1 스레드 대비 한 번 더할 때 늘어난 시간 = 캐시 라인 주고받는 비용
+        if(per_iter){
+            printf("%8s", "ns/op+");
+            for(int k = 0; k < nkinds; k++){
+                double ops = run(kinds[k], max_threads, iters, per_iter);
+                printf(" %14.2f", 1e9 * max_threads / ops - 1e9 / base[k]);
+            }
+            printf("   (contended ns per add minus uncontended, %d threads)\n", max_threads);
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
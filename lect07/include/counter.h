@@ -0,0 +1,45 @@
+#ifndef COUNTER_H
+#define COUNTER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define CACHE_LINE 64
+
+/* Pthread.c 의 acc 누적 방식들 */
+typedef enum {
+    COUNTER_MUTEX,      // pthread_mutex_t 로 보호 (기존 방식)
+    COUNTER_ATOMIC,     // atomic_fetch_add 하나
+    COUNTER_SLOTS,      // 스레드마다 캐시 라인 하나, 읽을 때 합산
+    COUNTER_PACKED,     // 슬롯을 붙여 놓은 것 (false sharing 비교용)
+    COUNTER_SHARDED     // 샤드 여러 개에 나눠서 atomic 더하기
+} counter_kind;
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_long v;
+} counter_slot;
+
+typedef struct {
+    counter_kind kind;
+    int nslots;
+    pthread_mutex_t mtx;
+    long plain;                 // COUNTER_MUTEX
+    _Alignas(CACHE_LINE) atomic_long single;    // COUNTER_ATOMIC
+    counter_slot *slots;        // COUNTER_SLOTS / COUNTER_SHARDED
+    atomic_long *packed;        // COUNTER_PACKED
+} counter_t;
+
+/* nslots: SLOTS/PACKED 는 스레드 수, SHARDED 는 샤드 수 */
+int counter_init(counter_t *c, counter_kind kind, int nslots);
+void counter_destroy(counter_t *c);
+/* tid 는 0 부터 시작하는 호출 스레드 번호 */
+void counter_add(counter_t *c, int tid, long delta);
+long counter_read(counter_t *c);
+const char *counter_name(counter_kind kind);
+
+/* 리덕션: 스레드별 부분합을 counter 에 합친다 (한 스레드가 한 번만 더함) */
+static inline void counter_reduce(counter_t *c, int tid, long partial){
+    counter_add(c, tid, partial);
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef LOCKS_H
+#define LOCKS_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* Pthread.c 의 임계 구역에 끼워 넣을 수 있는 락들 */
+typedef enum {
+    LOCK_MUTEX,     // pthread_mutex_t
+    LOCK_TAS,       // test-and-set + 지수 백오프
+    LOCK_TTAS,      // test-and-test-and-set + 지수 백오프
+    LOCK_TICKET,    // 번호표 락 (FIFO)
+    LOCK_MCS,       // MCS 큐 락 (자기 노드에서만 스핀)
+    LOCK_FUTEX,     // futex 로 직접 만든 mutex (0: 풀림, 1: 잠김, 2: 대기자 있음)
+    LOCK_KIND_COUNT
+} lock_kind;
+
+/* MCS 가 쓰는 스레드별 노드. 다른 락은 무시한다 */
+typedef struct mcs_node {
+    _Atomic(struct mcs_node *) next;
+    atomic_int locked;
+} mcs_node;
+
+typedef struct {
+    lock_kind kind;
+    union {
+        pthread_mutex_t mtx;
+        atomic_int flag;                        // TAS/TTAS
+        struct {
+            atomic_uint next;
+            atomic_uint serving;
+        } ticket;
+        _Atomic(mcs_node *) tail;               // MCS
+        atomic_uint word;                       // FUTEX
+    } u;
+} lock_t;
+
+void lock_init(lock_t *l, lock_kind kind);
+void lock_destroy(lock_t *l);
+void lock_acquire(lock_t *l, mcs_node *me);
+void lock_release(lock_t *l, mcs_node *me);
+const char *lock_name(lock_kind kind);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <sys/types.h>
+
+/* process_contral.c 의 SIGSTOP/SIGCONT 를 자동으로: 워커 묶음(그룹)마다 프로세스 그룹을 따로 두고,
+ * 매 주기(period)의 앞부분만 SIGCONT, 나머지는 SIGSTOP 해서 그룹의 CPU 사용량을 share 로 맞춘다.
+ * 실제 사용량은 /proc/<pid>/schedstat (없으면 /proc/<pid>/stat 의 utime+stime) 으로 재고, 누적 오차를 다음 주기의 켜 둘 시간에 반영한다.
+ * share 는 "초당 CPU 초" (0.5 = CPU 반 개). */
+
+typedef void (*sv_worker)(void *arg);
+
+typedef struct {
+    double share;           // 목표
+    double achieved;        // 실제 (CPU 초 / 경과 초)
+    double mean_duty;       // 주기 중 켜 둔 비율의 평균
+    int nworkers;
+    pid_t pgid;
+} sv_group_stats;
+
+typedef struct {
+    long periods;
+    double wall;            // sv_run 경과 시간
+    double cpu;             // 감독 프로세스가 쓴 CPU 초
+    double late_mean, late_max;     // 타이머가 늦게 깬 정도 (초)
+    double sample_mean;     // 한 주기에 /proc 을 읽는 데 걸린 평균 시간 (초)
+} sv_overhead;
+
+typedef struct supervisor supervisor;
+
+/* period_sec: 듀티 사이클 주기 (예: 0.1) */
+supervisor *sv_create(double period_sec);
+/* 감독하는 그룹을 모두 SIGKILL 하고 거둔 뒤 해제 */
+void sv_destroy(supervisor *sv);
+
+/* 워커 nworkers 개를 새 프로세스 그룹으로 fork 한다. 워커는 첫 sv_run 까지 기다렸다가 fn(arg) 를 실행하고,
+ * 돌아오면 끝난다. 그룹 번호를 돌려주고, 실패하거나 이미 sv_run 을 불렀으면 -1 */
+int sv_add_group(supervisor *sv, double share, int nworkers, sv_worker fn, void *arg);
+
+/* seconds 동안 듀티 사이클을 돌린다. 끝나면 모든 그룹을 멈춘 상태로 둔다 */
+int sv_run(supervisor *sv, double seconds);
+
+void sv_get_group_stats(const supervisor *sv, int group, sv_group_stats *out);
+void sv_get_overhead(const supervisor *sv, sv_overhead *out);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+/* alarm() 은 프로세스당 하나, 1 초 단위이고 콜백이 시그널 핸들러 안에서 돈다 (boom.c, alarm_signal.c).
+ * 여기서는 계층형 타이밍 휠(256 칸 + 64 칸 x 4 단)에 타이머를 무제한 걸고,
+ * timerfd 하나를 해상도(resolution) 간격으로 돌려 만료된 타이머의 콜백을 일반 문맥에서 부른다.
+ * 걸기/취소는 리스트에 넣고 빼기뿐이라 O(1). 만료 시각은 해상도 단위로 올림된다. */
+
+typedef struct tw_list {
+    struct tw_list *next, *prev;
+} tw_list;
+
+typedef struct tw_timer tw_timer;
+typedef void (*tw_callback)(tw_timer *t, void *arg);
+
+/* 호출하는 쪽이 잡아 두는 타이머 (구조체에 넣어 두고 쓰면 할당이 필요 없다) */
+struct tw_timer {
+    tw_list link;               // 반드시 첫 멤버
+    uint64_t expires;           // 만료 tick
+    tw_callback cb;
+    void *arg;
+    int pending;                // 휠에 걸려 있으면 1
+};
+
+typedef struct timer_wheel timer_wheel;
+
+/* resolution_ns 간격의 tick 으로 도는 휠. 실패하면 NULL */
+timer_wheel *tw_create(uint64_t resolution_ns);
+void tw_destroy(timer_wheel *tw);
+
+void tw_timer_init(tw_timer *t, tw_callback cb, void *arg);
+/* delay_ns 뒤에 만료. 이미 걸려 있으면 다시 건다 */
+void tw_arm(timer_wheel *tw, tw_timer *t, uint64_t delay_ns);
+/* 걸려 있지 않으면 아무 일도 하지 않는다. 콜백 안에서 불러도 된다 */
+void tw_cancel(timer_wheel *tw, tw_timer *t);
+
+/* epoll/poll 에 넣을 timerfd. 읽을 수 있으면 tw_process 를 부른다 */
+int tw_fd(const timer_wheel *tw);
+/* 지금 시각까지 만료된 타이머의 콜백을 부르고, 부른 개수를 돌려준다 */
+long tw_process(timer_wheel *tw);
+/* timerfd 를 timeout_ms 동안(-1 이면 무한) 기다렸다가 tw_process */
+long tw_wait(timer_wheel *tw, int timeout_ms);
+
+/* 걸려 있는 타이머 수 */
+long tw_pending(const timer_wheel *tw);
+
+#endif
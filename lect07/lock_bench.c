@@ -0,0 +1,158 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "locks.h"
+
+/* Pthread.c 의 acc 임계 구역을 락 종류별로 돌려 본다.
+ * 스레드 수(온라인 CPU 수의 4배까지 = 과다 구독 포함)와 임계 구역 길이를 바꿔 가며
+ * 처리량, 스레드별 획득 횟수(공정성), 획득 지연 p99 를 출력한다.
+ * 사용법: ./lock_bench [최대 스레드 수(4 x CPU)] [측정 시간 ms(200)] */
+
+#define MAX_LAT_SAMPLES (1 << 16)
+#define LAT_EVERY 8         // 8 번 중 한 번만 시간을 잰다
+
+volatile long acc = 0;      // 임계 구역에서 갱신하는 공유 변수 (volatile: 반복이 접히지 않게)
+
+typedef struct {
+    lock_t *lock;
+    int cs_len;             // 임계 구역 안 반복 수
+    long acquisitions;
+    long *lat;              // 획득 지연 샘플 (ns)
+    int nlat;
+    char pad[64];
+} bench_arg;
+
+static atomic_int running;
+static pthread_barrier_t start_barrier;
+
+static inline long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void *TaskCode(void *argument){
+    bench_arg *a = argument;
+    mcs_node me;
+    long n = 0;
+
+    pthread_barrier_wait(&start_barrier);
+    while(atomic_load_explicit(&running, memory_order_relaxed)){
+        long long t0 = 0;
+        int sample = (n % LAT_EVERY) == 0 && a->nlat < MAX_LAT_SAMPLES;
+
+        if(sample)
+            t0 = now_ns();
+        lock_acquire(a->lock, &me);
+        if(sample)
+            a->lat[a->nlat++] = now_ns() - t0;
+
+        for(int i = 0; i < a->cs_len; i++)
+            acc++;
+        acc++;
+
+        lock_release(a->lock, &me);
+        n++;
+
+        // 임계 구역 밖의 짧은 작업
+        for(volatile int i = 0; i < 50; i++)
+            ;
+    }
+    a->acquisitions = n;
+    return NULL;
+}
+
+static int cmp_long(const void *a, const void *b){
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+static void run(lock_kind kind, int nthreads, int cs_len, int ms){
+    pthread_t threads[nthreads];
+    bench_arg args[nthreads];
+    lock_t lock;
+    long total = 0, min_acq = -1, max_acq = 0;
+    double sum = 0, sumsq = 0;
+    int nlat = 0;
+    long *all;
+
+    lock_init(&lock, kind);
+    acc = 0;
+    atomic_store(&running, 1);
+    pthread_barrier_init(&start_barrier, NULL, nthreads + 1);
+    for(int i = 0; i < nthreads; i++){
+        memset(&args[i], 0, sizeof(args[i]));
+        args[i].lock = &lock;
+        args[i].cs_len = cs_len;
+        args[i].lat = malloc(sizeof(long) * MAX_LAT_SAMPLES);
+        pthread_create(&threads[i], NULL, TaskCode, &args[i]);
+    }
+    pthread_barrier_wait(&start_barrier);
+    usleep(ms * 1000);
+    atomic_store(&running, 0);
+    for(int i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+    pthread_barrier_destroy(&start_barrier);
+
+    for(int i = 0; i < nthreads; i++){
+        long a = args[i].acquisitions;
+        total += a;
+        sum += a;
+        sumsq += (double)a * a;
+        if(min_acq < 0 || a < min_acq) min_acq = a;
+        if(a > max_acq) max_acq = a;
+        nlat += args[i].nlat;
+    }
+    if(acc != total * (cs_len + 1)){
+        fprintf(stderr, "%s: mutual exclusion broken (%ld != %ld)\n",
+                lock_name(kind), acc, total * (cs_len + 1));
+        exit(1);
+    }
+
+    all = malloc(sizeof(long) * (nlat > 0 ? nlat : 1));
+    nlat = 0;
+    for(int i = 0; i < nthreads; i++){
+        memcpy(all + nlat, args[i].lat, sizeof(long) * args[i].nlat);
+        nlat += args[i].nlat;
+        free(args[i].lat);
+    }
+    qsort(all, nlat, sizeof(long), cmp_long);
+
+    // Jain 공정성 지수: 1 이면 모든 스레드가 똑같이 획득
+    printf("%-7s %7d %6d %12.0f %9ld %9ld %7.3f %10.0f %10.0f\n",
+           lock_name(kind), nthreads, cs_len, total / (ms / 1000.0),
+           min_acq, max_acq, sumsq > 0 ? sum * sum / (nthreads * sumsq) : 0,
+           nlat ? (double)all[nlat / 2] : 0, nlat ? (double)all[(long)nlat * 99 / 100] : 0);
+    free(all);
+    lock_destroy(&lock);
+}
+
+int main(int argc, char *argv[]){
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = ncpu * 4;
+    int ms = 200;
+    int cs_lens[] = { 0, 100, 1000 };
+
+    if(argc > 1) max_threads = atoi(argv[1]);
+    if(argc > 2) ms = atoi(argv[2]);
+    if(max_threads < 1 || ms < 1){
+        fprintf(stderr, "Usage : %s [max_threads] [ms]\n", argv[0]);
+        exit(1);
+    }
+
+    printf("online CPUs: %ld (threads above this are oversubscribed)\n", ncpu);
+    printf("%-7s %7s %6s %12s %9s %9s %7s %10s %10s\n",
+           "lock", "threads", "cs", "acq/s", "min/thr", "max/thr", "jain", "p50(ns)", "p99(ns)");
+    for(unsigned c = 0; c < sizeof(cs_lens) / sizeof(cs_lens[0]); c++){
+        for(int n = 1; n <= max_threads; n *= 2){
+            for(int k = 0; k < LOCK_KIND_COUNT; k++)
+                run(k, n, cs_lens[c], ms);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "locks.h"
+
+#define BACKOFF_MIN 4
+#define BACKOFF_MAX 1024
+#define SPIN_LIMIT 4096     // 이만큼 돌면 양보 (CPU 보다 스레드가 많을 때 대비)
+
+static inline void cpu_relax(void){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
+static inline void backoff(unsigned *delay, unsigned *spins){
+    for(unsigned i = 0; i < *delay; i++)
+        cpu_relax();
+    if(*delay < BACKOFF_MAX)
+        *delay <<= 1;
+    *spins += *delay;
+    if(*spins >= SPIN_LIMIT){
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+static void futex_wait(atomic_uint *addr, unsigned val){
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint *addr, int n){
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+void lock_init(lock_t *l, lock_kind kind){
+    l->kind = kind;
+    switch(kind){
+    case LOCK_MUTEX:
+        pthread_mutex_init(&l->u.mtx, NULL);
+        break;
+    case LOCK_TAS:
+    case LOCK_TTAS:
+        atomic_init(&l->u.flag, 0);
+        break;
+    case LOCK_TICKET:
+        atomic_init(&l->u.ticket.next, 0);
+        atomic_init(&l->u.ticket.serving, 0);
+        break;
+    case LOCK_MCS:
+        atomic_init(&l->u.tail, NULL);
+        break;
+    case LOCK_FUTEX:
+        atomic_init(&l->u.word, 0);
+        break;
+    default:
+        break;
+    }
+}
+
+void lock_destroy(lock_t *l){
+    if(l->kind == LOCK_MUTEX)
+        pthread_mutex_destroy(&l->u.mtx);
+}
+
+void lock_acquire(lock_t *l, mcs_node *me){
+    unsigned delay = BACKOFF_MIN, spins = 0;
+
+    switch(l->kind){
+    case LOCK_MUTEX:
+        pthread_mutex_lock(&l->u.mtx);
+        break;
+
+    case LOCK_TAS:
+        while(atomic_exchange_explicit(&l->u.flag, 1, memory_order_acquire))
+            backoff(&delay, &spins);
+        break;
+
+    case LOCK_TTAS:
+        for(;;){
+            while(atomic_load_explicit(&l->u.flag, memory_order_relaxed))
+                backoff(&delay, &spins);
+            if(!atomic_exchange_explicit(&l->u.flag, 1, memory_order_acquire))
+                break;
+        }
+        break;
+
+    case LOCK_TICKET: {
+        unsigned my = atomic_fetch_add_explicit(&l->u.ticket.next, 1, memory_order_relaxed);
+        unsigned cur;
+        // 앞에 남은 사람 수에 비례해서 쉰다
+        while((cur = atomic_load_explicit(&l->u.ticket.serving, memory_order_acquire)) != my){
+            for(unsigned i = 0; i < (my - cur) * BACKOFF_MIN; i++)
+                cpu_relax();
+            if(++spins >= SPIN_LIMIT / BACKOFF_MIN){
+                spins = 0;
+                sched_yield();
+            }
+        }
+        break;
+    }
+
+    case LOCK_MCS: {
+        mcs_node *prev;
+        atomic_store_explicit(&me->next, NULL, memory_order_relaxed);
+        atomic_store_explicit(&me->locked, 1, memory_order_relaxed);
+        prev = atomic_exchange_explicit(&l->u.tail, me, memory_order_acq_rel);
+        if(prev != NULL){
+            atomic_store_explicit(&prev->next, me, memory_order_release);
+            while(atomic_load_explicit(&me->locked, memory_order_acquire)){
+                cpu_relax();
+                if(++spins >= SPIN_LIMIT){
+                    spins = 0;
+                    sched_yield();
+                }
+            }
+        }
+        break;
+    }
+
+    case LOCK_FUTEX: {
+        unsigned c = 0;
+        if(atomic_compare_exchange_strong(&l->u.word, &c, 1))
+            break;
+        // 대기자가 있다고 표시(2)하고 잠든다
+        if(c != 2)
+            c = atomic_exchange(&l->u.word, 2);
+        while(c != 0){
+            futex_wait(&l->u.word, 2);
+            c = atomic_exchange(&l->u.word, 2);
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void lock_release(lock_t *l, mcs_node *me){
+    switch(l->kind){
+    case LOCK_MUTEX:
+        pthread_mutex_unlock(&l->u.mtx);
+        break;
+
+    case LOCK_TAS:
+    case LOCK_TTAS:
+        atomic_store_explicit(&l->u.flag, 0, memory_order_release);
+        break;
+
+    case LOCK_TICKET:
+        atomic_store_explicit(&l->u.ticket.serving,
+                atomic_load_explicit(&l->u.ticket.serving, memory_order_relaxed) + 1,
+                memory_order_release);
+        break;
+
+    case LOCK_MCS: {
+        mcs_node *next = atomic_load_explicit(&me->next, memory_order_acquire);
+        if(next == NULL){
+            mcs_node *expect = me;
+            if(atomic_compare_exchange_strong_explicit(&l->u.tail, &expect, NULL,
+                        memory_order_acq_rel, memory_order_relaxed))
+                break;
+            // 뒤에 오는 스레드가 next 를 연결할 때까지 기다린다
+            while((next = atomic_load_explicit(&me->next, memory_order_acquire)) == NULL)
+                sched_yield();
+        }
+        atomic_store_explicit(&next->locked, 0, memory_order_release);
+        break;
+    }
+
+    case LOCK_FUTEX:
+        if(atomic_fetch_sub(&l->u.word, 1) != 1){
+            atomic_store(&l->u.word, 0);
+            futex_wake(&l->u.word, 1);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+const char *lock_name(lock_kind kind){
+    switch(kind){
+    case LOCK_MUTEX:  return "mutex";
+    case LOCK_TAS:    return "tas";
+    case LOCK_TTAS:   return "ttas";
+    case LOCK_TICKET: return "ticket";
+    case LOCK_MCS:    return "mcs";
+    case LOCK_FUTEX:  return "futex";
+    default:          return "?";
+    }
+}
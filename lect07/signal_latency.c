@@ -0,0 +1,284 @@
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+/* 시그널 전달 지연과 최대 전달률을 받는 방식별로 잰다.
+ * 스케줄러의 kill(pid, SIGUSR1) -> pause() 와 signal_handler.c 의 핸들러 방식을 기준으로,
+ *   보내기: 표준 시그널(kill, SIGUSR1) / 실시간 시그널(sigqueue, SIGRTMIN + payload)
+ *   받기  : 핸들러(sigsuspend 로 대기) / sigwaitinfo / signalfd + epoll
+ * latency : 한 번 보내고 받은 쪽이 확인할 때까지 기다리기를 반복, 보낸 시각 -> 받은 시각
+ * burst   : 기다리지 않고 연달아 보냄. 받은 수, 잃은 수(표준 시그널은 대기 중이면 합쳐짐), 초당 전달 수
+ * idle 과 CPU 부하(바쁜 프로세스 nload 개) 두 경우를 돌린다.
+ * 사용법: ./signal_latency [latency 반복(20000)] [burst 수(100000)] [부하 프로세스 수(CPU 수)] */
+
+enum { RECV_HANDLER, RECV_SIGWAITINFO, RECV_SIGNALFD, RECV_COUNT };
+static const char *recv_name[] = { "handler", "sigwaitinfo", "signalfd+epoll" };
+
+typedef struct {
+    atomic_uint ack;            // 받은 쪽이 처리한 개수 (futex 워드)
+    atomic_uint done;           // burst 끝 (futex 워드)
+    long long t_send;           // latency: 보낸 시각 (ns)
+    long received, reordered;   // burst 결과
+    atomic_uint ready;          // 받는 쪽 준비 끝 (futex 워드)
+    long long lat[];            // latency: 회차별 지연 (ns)
+} shared;
+
+static shared *shm;
+static int use_rt;              // 실시간 시그널 + sigqueue
+static int sig_msg, sig_end;
+
+/* 핸들러 방식에서 핸들러가 채우는 값 */
+static volatile sig_atomic_t got_msg, got_end;
+static volatile long long handler_ts;
+static volatile long handler_val;
+
+static long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void futex_wait(atomic_uint *w, unsigned val){
+    syscall(SYS_futex, w, FUTEX_WAIT, val, NULL, NULL, 0);
+}
+
+static void futex_wake(atomic_uint *w){
+    syscall(SYS_futex, w, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static void on_signal(int signo, siginfo_t *si, void *uc){
+    (void)uc;
+    if(signo == sig_end){
+        got_end = 1;
+        return;
+    }
+    handler_ts = now_ns();
+    handler_val = si->si_value.sival_int;
+    got_msg++;
+}
+
+/* ---- 받는 쪽 (자식) ---- */
+
+typedef struct {
+    int method;
+    sigset_t set;               // sig_msg + sig_end
+    sigset_t wait_mask;         // 핸들러 방식: sigsuspend 동안 풀어 둘 마스크
+    int sfd, epfd;
+} receiver;
+
+/* 시그널 하나를 받는다. 끝 신호면 0, 메시지면 1. 받은 시각과 payload 를 돌려준다 */
+static int receive(receiver *r, long long *ts, long *val){
+    siginfo_t si;
+    struct signalfd_siginfo fsi;
+    struct epoll_event ev;
+
+    switch(r->method){
+    case RECV_HANDLER:
+        // 핸들러가 이미 돌았을 수 있으므로 시그널을 막은 채 확인하고, sigsuspend 로 풀면서 잔다
+        while(!got_msg && !got_end)
+            sigsuspend(&r->wait_mask);
+        if(got_msg){
+            got_msg--;
+            *ts = handler_ts;
+            *val = handler_val;
+            return 1;
+        }
+        return 0;
+    case RECV_SIGWAITINFO:
+        while(sigwaitinfo(&r->set, &si) == -1)
+            ;
+        *ts = now_ns();
+        *val = si.si_value.sival_int;
+        return si.si_signo != sig_end;
+    case RECV_SIGNALFD:
+        for(;;){
+            if(read(r->sfd, &fsi, sizeof(fsi)) == sizeof(fsi))
+                break;
+            epoll_wait(r->epfd, &ev, 1, -1);
+        }
+        *ts = now_ns();
+        *val = fsi.ssi_int;
+        return (int)fsi.ssi_signo != sig_end;
+    }
+    return 0;
+}
+
+static void receiver_main(int method, long iters){
+    receiver r = { .method = method };
+    struct sigaction sa;
+    long long ts;
+    long val, expect = 0;
+
+    sigemptyset(&r.set);
+    sigaddset(&r.set, sig_msg);
+    sigaddset(&r.set, sig_end);
+    // 어느 방식이든 평소에는 막아 둔다 (fork 전에 부모가 이미 막아 두었음)
+    sigprocmask(SIG_BLOCK, &r.set, &r.wait_mask);
+    sigdelset(&r.wait_mask, sig_msg);
+    sigdelset(&r.wait_mask, sig_end);
+
+    if(method == RECV_HANDLER){
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = on_signal;
+        sa.sa_flags = SA_SIGINFO;
+        // 메시지 핸들러 도중에 끝 신호가 끼어들면(중첩) 남은 메시지보다 먼저 처리되므로 둘 다 막는다
+        sa.sa_mask = r.set;
+        sigaction(sig_msg, &sa, NULL);
+        sigaction(sig_end, &sa, NULL);
+    } else if(method == RECV_SIGNALFD){
+        struct epoll_event ev = { .events = EPOLLIN };
+        r.sfd = signalfd(-1, &r.set, SFD_NONBLOCK);
+        r.epfd = epoll_create1(0);
+        ev.data.fd = r.sfd;
+        epoll_ctl(r.epfd, EPOLL_CTL_ADD, r.sfd, &ev);
+    }
+    atomic_store(&shm->ready, 1);
+    futex_wake(&shm->ready);
+
+    // latency: 하나 받을 때마다 확인
+    for(long i = 0; i < iters; i++){
+        if(!receive(&r, &ts, &val))
+            break;
+        shm->lat[i] = ts - shm->t_send;
+        atomic_store(&shm->ack, i + 1);
+        futex_wake(&shm->ack);
+    }
+    // burst: 끝 신호까지 센다. 실시간 시그널은 payload 로 순서도 확인
+    while(receive(&r, &ts, &val)){
+        shm->received++;
+        if(use_rt && val != expect)
+            shm->reordered++;
+        expect = val + 1;
+    }
+    atomic_store(&shm->done, 1);
+    futex_wake(&shm->done);
+    _exit(0);
+}
+
+/* ---- 보내는 쪽 (부모) ---- */
+
+static long eagain;
+
+static void send_sig(pid_t pid, int sig, int val){
+    if(!use_rt){
+        kill(pid, sig);
+        return;
+    }
+    union sigval sv = { .sival_int = val };
+    // 받는 쪽 큐(RLIMIT_SIGPENDING)가 차면 EAGAIN: 양보하고 다시
+    while(sigqueue(pid, sig, sv) == -1){
+        if(errno != EAGAIN)
+            return;
+        eagain++;
+        sched_yield();
+    }
+}
+
+static int cmp_ll(const void *a, const void *b){
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+static void run(int method, int rt, const char *load, long iters, long burst){
+    sigset_t set, old;
+    pid_t pid;
+    long long t0, dt;
+
+    use_rt = rt;
+    sig_msg = rt ? SIGRTMIN : SIGUSR1;
+    sig_end = rt ? SIGRTMIN + 1 : SIGUSR2;    // 번호가 커서 같은 때 대기 중이면 메시지보다 나중에 전달된다
+    memset(shm, 0, sizeof(*shm));
+    eagain = 0;
+
+    // 자식이 받을 준비를 하기 전에 온 시그널이 기본 동작(종료)으로 처리되지 않도록 fork 전에 막는다
+    sigemptyset(&set);
+    sigaddset(&set, sig_msg);
+    sigaddset(&set, sig_end);
+    sigprocmask(SIG_BLOCK, &set, &old);
+    if((pid = fork()) == 0)
+        receiver_main(method, iters);
+    sigprocmask(SIG_SETMASK, &old, NULL);
+    // ready 자체를 futex 워드로 써야 검사와 잠들기 사이에 온 깨움을 놓치지 않는다
+    while(!atomic_load(&shm->ready))
+        futex_wait(&shm->ready, 0);
+
+    for(long i = 0; i < iters; i++){
+        shm->t_send = now_ns();
+        send_sig(pid, sig_msg, i);
+        while(atomic_load(&shm->ack) != (unsigned)(i + 1))
+            futex_wait(&shm->ack, i);
+    }
+
+    t0 = now_ns();
+    for(long i = 0; i < burst; i++)
+        send_sig(pid, sig_msg, i);
+    send_sig(pid, sig_end, 0);
+    while(!atomic_load(&shm->done))
+        futex_wait(&shm->done, 0);
+    dt = now_ns() - t0;
+    waitpid(pid, NULL, 0);
+
+    qsort(shm->lat, iters, sizeof(long long), cmp_ll);
+    printf("%-8s %-14s %-5s %8.1f %8.1f %9.1f %10.0f %8ld %8ld %6.1f %8ld %7ld\n",
+            rt ? "sigqueue" : "kill", recv_name[method], load,
+            shm->lat[iters / 2] / 1e3, shm->lat[iters * 99 / 100] / 1e3, shm->lat[iters - 1] / 1e3,
+            shm->received / (dt / 1e9), burst, shm->received,
+            (burst - shm->received) * 100.0 / burst, shm->reordered, eagain);
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]){
+    long iters = 20000, burst = 100000;
+    int nload = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if(argc > 1) iters = atol(argv[1]);
+    if(argc > 2) burst = atol(argv[2]);
+    if(argc > 3) nload = atoi(argv[3]);
+    if(iters < 1 || burst < 1 || nload < 0){
+        fprintf(stderr, "Usage : %s [latency_iters] [burst] [load_procs]\n", argv[0]);
+        exit(1);
+    }
+    shm = mmap(NULL, sizeof(shared) + sizeof(long long) * iters, PROT_READ|PROT_WRITE,
+            MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if(shm == MAP_FAILED){
+        perror("mmap");
+        exit(1);
+    }
+
+    printf("%-8s %-14s %-5s %8s %8s %9s %10s %8s %8s %6s %8s %7s\n", "send", "receive", "load",
+            "p50_us", "p99_us", "max_us", "burst/s", "sent", "recv", "lost%", "reorder", "EAGAIN");
+    for(int loaded = 0; loaded < 2; loaded++){
+        pid_t loaders[256];
+        int n = loaded ? (nload < 256 ? nload : 256) : 0;
+
+        for(int i = 0; i < n; i++){
+            if((loaders[i] = fork()) == 0){
+                volatile unsigned long x = 0;
+                for(;;)
+                    x++;
+            }
+        }
+        for(int rt = 0; rt < 2; rt++)
+            for(int m = 0; m < RECV_COUNT; m++)
+                run(m, rt, loaded ? "busy" : "idle", iters, burst);
+        for(int i = 0; i < n; i++){
+            kill(loaders[i], SIGKILL);
+            waitpid(loaders[i], NULL, 0);
+        }
+    }
+    return 0;
+}
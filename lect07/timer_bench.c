@@ -0,0 +1,114 @@
+#define _GNU_SOURCE
+#include <sys/epoll.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "timer_wheel.h"
+
+/* timer_wheel 의 걸기/취소/만료 처리량과 만료 지연(jitter)을 잰다.
+ *   arm    : 타이머 N 개를 0~10 초 사이 임의 시각에 건다
+ *   cancel : 그 N 개를 건 순서와 다르게 취소한다
+ *   fire   : N 개를 0~span 사이 임의 시각에 걸고 epoll 로 timerfd 를 기다리며 모두 만료시킨다.
+ *            jitter = 콜백이 불린 시각 - 요청한 만료 시각 (해상도만큼의 올림이 포함된다)
+ * 사용법: ./timer_bench [타이머 수(200000)] [해상도 us(1000)] [fire 구간 ms(1000)] */
+
+typedef struct {
+    tw_timer t;
+    long long deadline;         // 요청한 만료 시각 (ns)
+} item;
+
+static long long *jitter;
+static long nfired;
+
+static long long now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void on_fire(tw_timer *t, void *arg){
+    item *it = (item *)t;
+    (void)arg;
+    jitter[nfired++] = now_ns() - it->deadline;
+}
+
+static int cmp_ll(const void *a, const void *b){
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[]){
+    long n = 200000, res_us = 1000, span_ms = 1000, *order;
+    struct epoll_event ev = { .events = EPOLLIN };
+    timer_wheel *tw;
+    item *items;
+    long long t0, dt;
+    int epfd;
+
+    if(argc > 1) n = atol(argv[1]);
+    if(argc > 2) res_us = atol(argv[2]);
+    if(argc > 3) span_ms = atol(argv[3]);
+    if(n < 1 || res_us < 1 || span_ms < 1){
+        fprintf(stderr, "Usage : %s [timers] [resolution_us] [span_ms]\n", argv[0]);
+        exit(1);
+    }
+    items = malloc(sizeof(item) * n);
+    order = malloc(sizeof(long) * n);
+    jitter = malloc(sizeof(long long) * n);
+    if(items == NULL || order == NULL || jitter == NULL || (tw = tw_create(res_us * 1000ULL)) == NULL){
+        perror("init");
+        exit(1);
+    }
+    srand(1);
+    for(long i = 0; i < n; i++){
+        tw_timer_init(&items[i].t, on_fire, NULL);
+        order[i] = i;
+    }
+    for(long i = n - 1; i > 0; i--){
+        long j = ((long)rand() * RAND_MAX + rand()) % (i + 1), tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    printf("timers %ld, resolution %ld us\n", n, res_us);
+
+    // arm / cancel
+    t0 = now_ns();
+    for(long i = 0; i < n; i++)
+        tw_arm(tw, &items[i].t, (long long)rand() % 10000 * 1000000LL);
+    dt = now_ns() - t0;
+    printf("arm     %8.1f ns/op %12.0f ops/s  (pending %ld)\n", (double)dt / n, n / (dt / 1e9), tw_pending(tw));
+    t0 = now_ns();
+    for(long i = 0; i < n; i++)
+        tw_cancel(tw, &items[order[i]].t);
+    dt = now_ns() - t0;
+    printf("cancel  %8.1f ns/op %12.0f ops/s  (pending %ld)\n", (double)dt / n, n / (dt / 1e9), tw_pending(tw));
+
+    // fire
+    epfd = epoll_create1(0);
+    ev.data.ptr = tw;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, tw_fd(tw), &ev);
+    nfired = 0;
+    t0 = now_ns();
+    for(long i = 0; i < n; i++){
+        long long delay = (long long)rand() % (span_ms * 1000) * 1000;
+        items[i].deadline = now_ns() + delay;
+        tw_arm(tw, &items[i].t, delay);
+    }
+    while(tw_pending(tw) > 0){
+        if(epoll_wait(epfd, &ev, 1, -1) == 1)
+            tw_process(ev.data.ptr);
+    }
+    dt = now_ns() - t0;
+
+    qsort(jitter, nfired, sizeof(long long), cmp_ll);
+    printf("fire    %ld fired in %.3f s, %.0f timers/s\n", nfired, dt / 1e9, nfired / (dt / 1e9));
+    printf("jitter  min %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n", jitter[0] / 1e3,
+            jitter[nfired / 2] / 1e3, jitter[nfired * 99 / 100] / 1e3, jitter[nfired - 1] / 1e3);
+
+    tw_destroy(tw);
+    free(items);
+    free(order);
+    free(jitter);
+    return 0;
+}
@@ -0,0 +1,235 @@
+#define _GNU_SOURCE
+#include <sys/timerfd.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include "timer_wheel.h"
+
+/* 리눅스 커널의 예전 타이머 휠과 같은 배치:
+ * 1 단은 다음 256 tick 을 한 칸에 한 tick 씩, 2~5 단은 64 칸씩 점점 넓은 범위를 맡는다.
+ * 1 단이 한 바퀴 돌 때마다 위 단의 한 칸을 풀어 아래 단으로 다시 나눈다 (cascade). */
+#define ROOT_BITS 8
+#define LEVEL_BITS 6
+#define ROOT_SIZE (1 << ROOT_BITS)
+#define LEVEL_SIZE (1 << LEVEL_BITS)
+#define ROOT_MASK (ROOT_SIZE - 1)
+#define LEVEL_MASK (LEVEL_SIZE - 1)
+#define NLEVELS 4
+#define MAX_TICKS ((1ULL << (ROOT_BITS + NLEVELS * LEVEL_BITS)) - 1)
+
+struct timer_wheel {
+    tw_list root[ROOT_SIZE];
+    tw_list level[NLEVELS][LEVEL_SIZE];
+    uint64_t tick;              // 다음에 처리할 tick
+    uint64_t res_ns;
+    uint64_t base_ns;           // tick 0 의 시각
+    long pending;
+    int tfd;
+    int ticking;                // timerfd 가 돌고 있음
+};
+
+static uint64_t now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void list_init(tw_list *h){
+    h->next = h->prev = h;
+}
+
+static void list_add_tail(tw_list *h, tw_list *n){
+    n->prev = h->prev;
+    n->next = h;
+    h->prev->next = n;
+    h->prev = n;
+}
+
+static void list_del(tw_list *n){
+    n->prev->next = n->next;
+    n->next->prev = n->prev;
+    n->next = n->prev = n;
+}
+
+/* 남은 tick 수에 따라 들어갈 칸을 고른다 */
+static void place(timer_wheel *tw, tw_timer *t){
+    uint64_t expires = t->expires;
+    int64_t idx = (int64_t)(expires - tw->tick);
+    tw_list *slot;
+
+    if(idx < 0){
+        slot = &tw->root[tw->tick & ROOT_MASK];     // 이미 지난 것은 바로 다음 처리에
+    } else if(idx < ROOT_SIZE){
+        slot = &tw->root[expires & ROOT_MASK];
+    } else {
+        int lv;
+        if((uint64_t)idx > MAX_TICKS){
+            expires = tw->tick + MAX_TICKS;         // 범위 밖은 맨 끝 칸에 두고 cascade 때 다시 본다
+            idx = MAX_TICKS;
+        }
+        for(lv = 0; lv < NLEVELS - 1; lv++)
+            if((uint64_t)idx < 1ULL << (ROOT_BITS + (lv + 1) * LEVEL_BITS))
+                break;
+        slot = &tw->level[lv][(expires >> (ROOT_BITS + lv * LEVEL_BITS)) & LEVEL_MASK];
+    }
+    list_add_tail(slot, &t->link);
+}
+
+static void set_ticking(timer_wheel *tw, int on){
+    struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+
+    if(tw->ticking == on)
+        return;
+    if(on){
+        // 다음 tick 경계부터 해상도 간격으로
+        uint64_t first = tw->base_ns + tw->tick * tw->res_ns;
+        its.it_interval.tv_sec = tw->res_ns / 1000000000ULL;
+        its.it_interval.tv_nsec = tw->res_ns % 1000000000ULL;
+        its.it_value.tv_sec = first / 1000000000ULL;
+        its.it_value.tv_nsec = first % 1000000000ULL;
+        if(its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+            its.it_value.tv_nsec = 1;
+    }
+    timerfd_settime(tw->tfd, on ? TFD_TIMER_ABSTIME : 0, &its, NULL);
+    tw->ticking = on;
+}
+
+timer_wheel *tw_create(uint64_t resolution_ns){
+    timer_wheel *tw = malloc(sizeof(*tw));
+
+    if(tw == NULL || resolution_ns == 0){
+        free(tw);
+        return NULL;
+    }
+    for(int i = 0; i < ROOT_SIZE; i++)
+        list_init(&tw->root[i]);
+    for(int l = 0; l < NLEVELS; l++)
+        for(int i = 0; i < LEVEL_SIZE; i++)
+            list_init(&tw->level[l][i]);
+    tw->res_ns = resolution_ns;
+    tw->base_ns = now_ns();
+    tw->tick = 1;
+    tw->pending = 0;
+    tw->ticking = 0;
+    if((tw->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC)) == -1){
+        free(tw);
+        return NULL;
+    }
+    return tw;
+}
+
+void tw_destroy(timer_wheel *tw){
+    close(tw->tfd);
+    free(tw);
+}
+
+void tw_timer_init(tw_timer *t, tw_callback cb, void *arg){
+    list_init(&t->link);
+    t->expires = 0;
+    t->cb = cb;
+    t->arg = arg;
+    t->pending = 0;
+}
+
+void tw_arm(timer_wheel *tw, tw_timer *t, uint64_t delay_ns){
+    // 만료 시각을 tick 경계로 올림해서 일찍 불리는 일이 없게 한다
+    uint64_t rel = now_ns() - tw->base_ns;
+    uint64_t now_tick = rel / tw->res_ns;
+    uint64_t expires = (rel + delay_ns + tw->res_ns - 1) / tw->res_ns;
+
+    // 쉬는 동안 멈춰 있던 휠은 지금으로 당겨 둔다 (걸린 타이머가 없으니 건너뛸 칸도 없다)
+    if(tw->pending == 0 && tw->tick <= now_tick)
+        tw->tick = now_tick + 1;
+    if(expires < tw->tick)
+        expires = tw->tick;
+    if(t->pending)
+        list_del(&t->link);
+    else
+        tw->pending++;
+    t->expires = expires;
+    t->pending = 1;
+    place(tw, t);
+    set_ticking(tw, 1);
+}
+
+void tw_cancel(timer_wheel *tw, tw_timer *t){
+    if(!t->pending)
+        return;
+    list_del(&t->link);
+    t->pending = 0;
+    tw->pending--;
+}
+
+/* lv 단의 idx 칸을 비워 아래 단으로 다시 나눈다. 돌려준 idx 가 0 이면 윗 단도 풀어야 한다 */
+static int cascade(timer_wheel *tw, int lv, int idx){
+    tw_list tmp, *n;
+
+    list_init(&tmp);
+    // 칸 전체를 tmp 로 옮긴 뒤 하나씩 다시 넣는다
+    if(tw->level[lv][idx].next != &tw->level[lv][idx]){
+        tmp.next = tw->level[lv][idx].next;
+        tmp.prev = tw->level[lv][idx].prev;
+        tmp.next->prev = &tmp;
+        tmp.prev->next = &tmp;
+        list_init(&tw->level[lv][idx]);
+    }
+    while((n = tmp.next) != &tmp){
+        list_del(n);
+        place(tw, (tw_timer *)n);
+    }
+    return idx;
+}
+
+long tw_process(timer_wheel *tw){
+    uint64_t target = (now_ns() - tw->base_ns) / tw->res_ns;
+    uint64_t expirations;
+    long fired = 0;
+
+    // timerfd 카운터를 비운다 (몇 tick 이 지났는지는 시계로 계산)
+    while(read(tw->tfd, &expirations, sizeof(expirations)) == sizeof(expirations))
+        ;
+    while(tw->tick <= target){
+        int idx = tw->tick & ROOT_MASK;
+        tw_list *slot = &tw->root[idx];
+
+        if(tw->pending == 0){
+            tw->tick = target + 1;  // 걸린 타이머가 없으면 건너뛴다
+            break;
+        }
+        if(idx == 0){
+            for(int lv = 0; lv < NLEVELS; lv++)
+                if(cascade(tw, lv, (tw->tick >> (ROOT_BITS + lv * LEVEL_BITS)) & LEVEL_MASK) != 0)
+                    break;
+        }
+        // 콜백이 다른 타이머를 취소하거나 다시 걸 수 있으므로 하나씩 떼어서 부른다
+        while(slot->next != slot){
+            tw_timer *t = (tw_timer *)slot->next;
+            list_del(&t->link);
+            t->pending = 0;
+            tw->pending--;
+            fired++;
+            t->cb(t, t->arg);
+        }
+        tw->tick++;
+    }
+    if(tw->pending == 0)
+        set_ticking(tw, 0);
+    return fired;
+}
+
+long tw_wait(timer_wheel *tw, int timeout_ms){
+    struct pollfd pfd = { .fd = tw->tfd, .events = POLLIN };
+
+    if(poll(&pfd, 1, timeout_ms) <= 0)
+        return 0;
+    return tw_process(tw);
+}
+
+int tw_fd(const timer_wheel *tw){
+    return tw->tfd;
+}
+
+long tw_pending(const timer_wheel *tw){
+    return tw->pending;
+}
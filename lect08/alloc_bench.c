@@ -0,0 +1,260 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "mempool.h"
+
+#define PAGE 4096
+
+/* mempool 의 pool/arena 를 glibc malloc 과 비교한다. 스레드 1 개와 N 개로 각각 돌린다.
+ *   churn : 스레드마다 obj 바이트짜리 객체 live 개를 잡아 두고, 임의의 하나를 해제하고 새로 받기를 반복
+ *           (PCB 같은 고정 크기 레코드) -> malloc/free 대 mp_pool_alloc/free
+ *   phase : 스레드마다 16~1024 바이트 임의 크기 live 개를 받고 한꺼번에 버리기를 반복
+ *           (한 회 실행 동안만 쓰는 상태) -> malloc 후 전부 free 대 mp_arena_alloc 후 reset
+ * 모든 스레드가 객체를 잡고 있는 시점에 RSS 를 재서, 살아 있는 바이트 대비 더 쓴 비율(frag)을 낸다.
+ * 사용법: ./alloc_bench [최대 스레드 수(16)] [스레드당 live 객체(20000)] [스레드당 반복(2000000)] [obj 크기(128)] */
+
+enum { A_MALLOC, A_POOL, A_POOL_HUGE, A_ARENA, A_ARENA_HUGE };
+static const char *alloc_name[] = { "malloc", "pool", "pool+huge", "arena", "arena+huge" };
+
+typedef struct {
+	int kind;
+	int phase;                  // 0 이면 churn, 1 이면 phase
+	long live, ops;
+	size_t obj_size;
+	mp_pool *pool;              // 모든 스레드가 같이 쓴다
+	pthread_mutex_t *gate;      // run() 이 barrier 를 만들 때까지 잡고 있다
+	pthread_barrier_t *held, *measured;
+	size_t live_bytes;          // 스레드가 채움
+	double sec, cpu;            // 측정 구간의 경과 시간, 이 스레드의 CPU 시간
+} job;
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double thread_cpu_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long rss_kb(void){
+	FILE *fp = fopen("/proc/self/statm", "r");
+	long size, rss = 0;
+
+	if(fp){
+		if(fscanf(fp, "%ld %ld", &size, &rss) != 2)
+			rss = 0;
+		fclose(fp);
+	}
+	return rss * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/* 벤치 도중의 할당 실패는 되돌릴 방법이 없으므로 알리고 끝낸다 */
+static void *must(void *p, const char *what){
+	if(p == NULL){
+		fprintf(stderr, "%s: out of memory\n", what);
+		exit(1);
+	}
+	return p;
+}
+
+/* 만들어진 스레드 수에 맞춰 barrier 가 준비될 때까지 기다린다 */
+static void wait_gate(job *j){
+	pthread_mutex_lock(j->gate);
+	pthread_mutex_unlock(j->gate);
+}
+
+/* xorshift: rand() 는 잠금이 있어서 스레드끼리 부딪친다 */
+static unsigned long next_rand(unsigned long *s){
+	*s ^= *s << 13;
+	*s ^= *s >> 7;
+	*s ^= *s << 17;
+	return *s;
+}
+
+static void *churn_worker(void *arg){
+	job *j = arg;
+	void **slot = must(malloc(sizeof(void *) * j->live), "slot");
+	unsigned long seed = (unsigned long)pthread_self() | 1;
+	double t0, c0;
+
+	for(long i = 0; i < j->live; i++){
+		slot[i] = must(j->kind == A_MALLOC ? malloc(j->obj_size) : mp_pool_alloc(j->pool), "alloc");
+		memset(slot[i], 1, 16);
+	}
+	t0 = now_sec();
+	c0 = thread_cpu_sec();
+	for(long i = 0; i < j->ops; i++){
+		long k = next_rand(&seed) % j->live;
+		if(j->kind == A_MALLOC){
+			free(slot[k]);
+			slot[k] = must(malloc(j->obj_size), "malloc");
+		} else {
+			mp_pool_free(j->pool, slot[k]);
+			slot[k] = must(mp_pool_alloc(j->pool), "mp_pool_alloc");
+		}
+		*(long *)slot[k] = i;
+	}
+	j->sec = now_sec() - t0;
+	j->cpu = thread_cpu_sec() - c0;
+	j->live_bytes = j->live * j->obj_size;
+	// 쓰지 않은 페이지는 RSS 에 잡히지 않으므로 측정 전에 객체의 모든 페이지를 건드린다
+	for(long i = 0; i < j->live; i++)
+		for(size_t off = 0; off < j->obj_size; off += PAGE)
+			((volatile char *)slot[i])[off] = 1;
+
+	wait_gate(j);
+	pthread_barrier_wait(j->held);
+	pthread_barrier_wait(j->measured);
+	for(long i = 0; i < j->live; i++){
+		if(j->kind == A_MALLOC)
+			free(slot[i]);
+		else
+			mp_pool_free(j->pool, slot[i]);
+	}
+	free(slot);
+	return NULL;
+}
+
+static void *phase_worker(void *arg){
+	job *j = arg;
+	void **slot = must(malloc(sizeof(void *) * j->live), "slot");
+	unsigned long seed = (unsigned long)pthread_self() | 1;
+	mp_arena *a = NULL;
+	long rounds = j->ops / j->live, last;
+	double t0, c0;
+
+	if(rounds < 1)
+		rounds = 1;
+	if(j->kind != A_MALLOC)
+		a = must(mp_arena_create(1 << 20, j->kind == A_ARENA_HUGE), "mp_arena_create");
+	t0 = now_sec();
+	c0 = thread_cpu_sec();
+	for(long r = 0; r < rounds; r++){
+		size_t bytes = 0;
+		for(long i = 0; i < j->live; i++){
+			size_t sz = 16 + next_rand(&seed) % 1009;
+			slot[i] = must(a ? mp_arena_alloc(a, sz, 0) : malloc(sz), "alloc");
+			*(long *)slot[i] = i;
+			bytes += sz;
+		}
+		j->live_bytes = bytes;
+		if(r == rounds - 1)
+			break;              // 마지막 회는 RSS 를 잰 뒤에 버린다
+		if(a)
+			mp_arena_reset(a);
+		else
+			for(long i = 0; i < j->live; i++)
+				free(slot[i]);
+	}
+	j->sec = now_sec() - t0;
+	j->cpu = thread_cpu_sec() - c0;
+	last = j->live;
+
+	wait_gate(j);
+	pthread_barrier_wait(j->held);
+	pthread_barrier_wait(j->measured);
+	if(a)
+		mp_arena_destroy(a);
+	else
+		for(long i = 0; i < last; i++)
+			free(slot[i]);
+	free(slot);
+	return NULL;
+}
+
+static void run(int phase, int kind, int nthreads, long live, long ops, size_t obj_size){
+	pthread_t tids[256];
+	job jobs[256];
+	pthread_barrier_t held, measured;
+	pthread_mutex_t gate = PTHREAD_MUTEX_INITIALIZER;
+	mp_pool *pool = NULL;
+	int n = 0;
+	long rss0, rss1;
+	size_t live_bytes = 0;
+	double sec = 0, cpu = 0, nops;
+
+	malloc_trim(0);             // 앞 회차에 free 한 힙이 RSS 에 남지 않도록
+	rss0 = rss_kb();
+	if(kind == A_POOL || kind == A_POOL_HUGE)
+		pool = must(mp_pool_create(obj_size, kind == A_POOL_HUGE), "mp_pool_create");
+	// 스레드를 다 못 만들 수도 있으므로 barrier 는 만든 수를 안 뒤에 준비한다
+	pthread_mutex_lock(&gate);
+	for(int i = 0; i < nthreads; i++){
+		jobs[n] = (job){ kind, phase, live, ops, obj_size, pool, &gate, &held, &measured, 0, 0 };
+		int err = pthread_create(&tids[n], NULL, phase ? phase_worker : churn_worker, &jobs[n]);
+		if(err != 0){
+			fprintf(stderr, "pthread_create: %s\n", strerror(err));
+			break;
+		}
+		n++;
+	}
+	pthread_barrier_init(&held, NULL, n + 1);
+	pthread_barrier_init(&measured, NULL, n + 1);
+	pthread_mutex_unlock(&gate);
+	pthread_barrier_wait(&held);
+	rss1 = rss_kb();
+	pthread_barrier_wait(&measured);
+	for(int i = 0; i < n; i++){
+		pthread_join(tids[i], NULL);
+		live_bytes += jobs[i].live_bytes;
+		cpu += jobs[i].cpu;
+		if(jobs[i].sec > sec)
+			sec = jobs[i].sec;
+	}
+	pthread_barrier_destroy(&held);
+	pthread_barrier_destroy(&measured);
+	pthread_mutex_destroy(&gate);
+	if(pool)
+		mp_pool_destroy(pool);
+	if(n == 0)
+		return;
+
+	// churn 은 free+alloc 한 쌍, phase 는 alloc 하나(해제는 reset/free 에 묶어서)를 한 번으로 센다
+	nops = phase ? (double)(ops / live > 0 ? ops / live : 1) * live : (double)ops;
+	nops *= n;
+	printf("%-6s %-11s %7d %9.1f %9.2f %9.1f %9.1f %7.1f\n", phase ? "phase" : "churn",
+			alloc_name[kind], n, cpu * 1e9 / nops, nops / sec / 1e6,
+			live_bytes / 1048576.0, (rss1 - rss0) / 1024.0,
+			rss1 > rss0 ? 100.0 * (1 - live_bytes / ((rss1 - rss0) * 1024.0)) : 0.0);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[]){
+	int max_threads = 16;
+	long live = 20000, ops = 2000000;
+	size_t obj_size = 128;
+	int threads[2];
+
+	if(argc > 1) max_threads = atoi(argv[1]);
+	if(argc > 2) live = atol(argv[2]);
+	if(argc > 3) ops = atol(argv[3]);
+	if(argc > 4) obj_size = atol(argv[4]);
+	if(max_threads < 1 || max_threads > 256 || live < 1 || ops < 1 || obj_size < 8){
+		fprintf(stderr, "Usage : %s [max_threads] [live_per_thread] [ops_per_thread] [obj_size]\n", argv[0]);
+		exit(1);
+	}
+	threads[0] = 1;
+	threads[1] = max_threads;
+
+	// ns/op 은 스레드들이 쓴 CPU 시간 / 전체 횟수 (코어보다 스레드가 많아도 대기 시간이 섞이지 않는다),
+	// Mops/s 는 전체 횟수 / 가장 늦게 끝난 스레드의 경과 시간
+	printf("%-6s %-11s %7s %9s %9s %9s %9s %7s\n", "work", "allocator", "threads",
+			"ns/op", "Mops/s", "live_MB", "rss_MB", "frag%");
+	for(int t = 0; t < (max_threads > 1 ? 2 : 1); t++){
+		for(int k = A_MALLOC; k <= A_POOL_HUGE; k++)
+			run(0, k, threads[t], live, ops, obj_size);
+		for(int k = A_MALLOC; k <= A_ARENA_HUGE; k++)
+			if(k == A_MALLOC || k >= A_ARENA)
+				run(1, k, threads[t], live, ops, obj_size);
+	}
+	return 0;
+}
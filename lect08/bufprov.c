@@ -0,0 +1,160 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+#include "bufprov.h"
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+#define PAGE_SIZE 4096
+#define HUGE_SIZE (2 * 1024 * 1024)
+#define MAX_THREADS 256
+
+typedef struct {
+	char *p;
+	size_t len;
+	int value;
+	int nontemporal;
+	int touch_only;
+} part;
+
+void bp_opts_default(bp_opts *o){
+	o->prefault = BP_PREFAULT_NONE;
+	o->nthreads = 1;
+	o->huge = 0;
+	o->nontemporal = 0;
+	o->fill = -1;
+}
+
+/* 캐시에 올리지 않고 메모리로 바로 쓴다. 큰 버퍼는 어차피 캐시에 남지 않으므로
+ * 읽기-수정-쓰기(RFO) 트래픽만 아낀다 */
+static void fill_nt(char *p, size_t len, int value){
+#ifdef __SSE2__
+	size_t head = (-(uintptr_t)p) & 63;
+
+	if(head > len)
+		head = len;
+	memset(p, value, head);
+	p += head;
+	len -= head;
+#ifdef __AVX__
+	__m256i v = _mm256_set1_epi8((char)value);
+	for(; len >= 64; p += 64, len -= 64){
+		_mm256_stream_si256((__m256i *)p, v);
+		_mm256_stream_si256((__m256i *)(p + 32), v);
+	}
+#else
+	__m128i v = _mm_set1_epi8((char)value);
+	for(; len >= 64; p += 64, len -= 64){
+		_mm_stream_si128((__m128i *)p, v);
+		_mm_stream_si128((__m128i *)(p + 16), v);
+		_mm_stream_si128((__m128i *)(p + 32), v);
+		_mm_stream_si128((__m128i *)(p + 48), v);
+	}
+#endif
+	_mm_sfence();
+#endif
+	memset(p, value, len);
+}
+
+static void *part_run(void *arg){
+	part *pt = arg;
+
+	if(pt->touch_only){
+		for(size_t off = 0; off < pt->len; off += PAGE_SIZE)
+			((volatile char *)pt->p)[off] = 0;
+	} else if(pt->nontemporal){
+		fill_nt(pt->p, pt->len, pt->value);
+	} else {
+		memset(pt->p, pt->value, pt->len);
+	}
+	return NULL;
+}
+
+/* [p, p+size) 를 nthreads 조각으로 나눠 처리. 조각 경계는 2 MB 단위라
+ * huge page 하나를 두 스레드가 나눠 받는 일이 없다 */
+static void run_parts(char *p, size_t size, int value, int nthreads, int nontemporal, int touch_only){
+	pthread_t tids[MAX_THREADS];
+	part parts[MAX_THREADS];
+	int created[MAX_THREADS];
+	size_t units = (size + HUGE_SIZE - 1) / HUGE_SIZE, off = 0;
+	int n;
+
+	if(size == 0)
+		return;
+	if(nthreads > MAX_THREADS)
+		nthreads = MAX_THREADS;
+	if(nthreads < 1)
+		nthreads = 1;
+	if((size_t)nthreads > units)
+		nthreads = units;
+	for(n = 0; n < nthreads; n++){
+		size_t len = (units / nthreads + ((size_t)n < units % nthreads)) * HUGE_SIZE;
+		if(off + len > size)
+			len = size - off;
+		parts[n] = (part){ p + off, len, value, nontemporal, touch_only };
+		off += len;
+	}
+	// 스레드를 못 만들면 그 조각은 여기서 직접
+	for(int i = 1; i < n; i++){
+		created[i] = pthread_create(&tids[i], NULL, part_run, &parts[i]) == 0;
+		if(!created[i])
+			part_run(&parts[i]);
+	}
+	part_run(&parts[0]);
+	for(int i = 1; i < n; i++)
+		if(created[i])
+			pthread_join(tids[i], NULL);
+}
+
+void bp_fill(void *p, size_t size, int value, int nthreads, int nontemporal){
+	run_parts(p, size, value, nthreads, nontemporal, 0);
+}
+
+void bp_touch(void *p, size_t size, int nthreads){
+	run_parts(p, size, 0, nthreads, 0, 1);
+}
+
+int bp_alloc(bp_buf *b, size_t size, const bp_opts *o){
+	int flags = MAP_PRIVATE|MAP_ANONYMOUS;
+	int faulted = 0;
+
+	b->size = size;
+	b->map_len = o->huge ? size + HUGE_SIZE : size;
+	// huge page 는 madvise 를 먼저 해야 하므로 MAP_POPULATE 를 mmap 에 붙일 수 없다
+	if(o->prefault == BP_PREFAULT_POPULATE && !o->huge)
+		flags |= MAP_POPULATE;
+	b->map = mmap(NULL, b->map_len, PROT_READ|PROT_WRITE, flags, -1, 0);
+	if(b->map == MAP_FAILED)
+		return -1;
+	b->data = b->map;
+	if(o->huge){
+		b->data = (char *)(((uintptr_t)b->map + HUGE_SIZE - 1) & ~(uintptr_t)(HUGE_SIZE - 1));
+		madvise(b->data, size, MADV_HUGEPAGE);
+	}
+
+	if(o->prefault == BP_PREFAULT_MADVISE || (o->prefault == BP_PREFAULT_POPULATE && o->huge)){
+		if(madvise(b->data, size, MADV_POPULATE_WRITE) == 0)
+			faulted = 1;
+		// 오래된 커널(EINVAL)이면 아래에서 touch/fill 로 대신한다
+	} else if(o->prefault == BP_PREFAULT_POPULATE){
+		faulted = 1;
+	}
+
+	if(o->fill >= 0)
+		bp_fill(b->data, size, o->fill, o->nthreads, o->nontemporal);
+	else if(!faulted)
+		bp_touch(b->data, size, o->nthreads);
+	return 0;
+}
+
+void bp_free(bp_buf *b){
+	munmap(b->map, b->map_len);
+}
@@ -0,0 +1,106 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "bufprov.h"
+
+/* 100 MB 부터 두 배씩 버퍼를 준비하는 데 걸리는 시간(time-to-ready)을 전략별로 잰다.
+ * 기준은 mem_manage_opt.c 의 malloc + memset(1) (한 스레드, 폴트마다 한 번씩).
+ * 사용 가능한 메모리의 80% 를 넘는 크기는 건너뛴다.
+ * 사용법: ./bufprov_bench [최대 MB(16384)] [스레드 수(코어 수)] */
+
+typedef struct {
+	const char *name;
+	int prefault, parallel, huge, nontemporal;
+} strategy;
+
+static const strategy strategies[] = {
+	{ "memset",           BP_PREFAULT_NONE,     0, 0, 0 },
+	{ "populate+memset",  BP_PREFAULT_POPULATE, 0, 0, 0 },
+	{ "madv_pop+memset",  BP_PREFAULT_MADVISE,  0, 0, 0 },
+	{ "parallel",         BP_PREFAULT_NONE,     1, 0, 0 },
+	{ "parallel+huge",    BP_PREFAULT_NONE,     1, 1, 0 },
+	{ "parallel+nt",      BP_PREFAULT_NONE,     1, 0, 1 },
+	{ "parallel+huge+nt", BP_PREFAULT_NONE,     1, 1, 1 },
+	{ "madv_pop+par+nt",  BP_PREFAULT_MADVISE,  1, 0, 1 },
+};
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long mem_available_mb(void){
+	FILE *fp = fopen("/proc/meminfo", "r");
+	char line[256];
+	long kb = -1;
+
+	if(fp == NULL)
+		return -1;
+	while(fgets(line, sizeof(line), fp))
+		if(sscanf(line, "MemAvailable: %ld", &kb) == 1)
+			break;
+	fclose(fp);
+	return kb < 0 ? -1 : kb / 1024;
+}
+
+int main(int argc, char *argv[]){
+	long max_mb = 16384, avail = mem_available_mb();
+	int nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	const int nstrat = sizeof(strategies) / sizeof(strategies[0]);
+
+	if(argc > 1) max_mb = atol(argv[1]);
+	if(argc > 2) nthreads = atoi(argv[2]);
+	if(max_mb < 100 || nthreads < 1){
+		fprintf(stderr, "Usage : %s [max_MB] [threads]\n", argv[0]);
+		exit(1);
+	}
+
+	printf("threads %d, available %ld MB\n", nthreads, avail);
+	printf("%-8s", "MB");
+	for(int s = 0; s < nstrat; s++)
+		printf(" %17s", strategies[s].name);
+	printf("   (ms, GB/s)\n");
+
+	for(long mb = 100; mb <= max_mb; mb = (mb * 2 > max_mb && mb < max_mb) ? max_mb : mb * 2){
+		size_t size = (size_t)mb << 20;
+
+		if(avail > 0 && mb > avail * 8 / 10){
+			printf("%-8ld skipped (only %ld MB available)\n", mb, avail);
+			break;
+		}
+		printf("%-8ld", mb);
+		for(int s = 0; s < nstrat; s++){
+			const strategy *st = &strategies[s];
+			bp_opts o;
+			bp_buf b;
+			double t0, dt;
+
+			bp_opts_default(&o);
+			o.prefault = st->prefault;
+			o.nthreads = st->parallel ? nthreads : 1;
+			o.huge = st->huge;
+			o.nontemporal = st->nontemporal;
+			o.fill = 1;
+
+			t0 = now_sec();
+			if(bp_alloc(&b, size, &o) == -1){
+				printf(" %17s", "fail");
+				continue;
+			}
+			dt = now_sec() - t0;
+			// 양 끝과 가운데가 채워졌는지 확인
+			if(b.data[0] != 1 || b.data[size / 2] != 1 || b.data[size - 1] != 1)
+				printf(" %17s", "BAD");
+			else
+				printf(" %8.1f %7.2f", dt * 1e3, size / dt / 1e9);
+			fflush(stdout);
+			bp_free(&b);
+		}
+		printf("\n");
+	}
+	return 0;
+}
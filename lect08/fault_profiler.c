@@ -0,0 +1,297 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/* mem_manage_opt.c 일반화: 버퍼 크기, 접근 패턴, 메모리 종류를 바꿔 가며 페이지 폴트를 잰다.
+ *   fresh : 새로 받은 버퍼를 처음 건드릴 때 (first-touch 폴트)
+ *   cow   : 부모가 다 채운 뒤 fork, 자식이 건드릴 때 (copy-on-write 폴트)
+ * 각 경우 minor/major 폴트 수, 폴트당 시간, fork 시간, fork 전후 RSS 를 출력한다.
+ * 사용법: ./fault_profiler [-s MB,MB,..] [-b backing,..] [-p pattern,..] [-t stride 페이지] */
+
+#define PAGE_SIZE 4096
+#define HUGE_SIZE (2 * 1024 * 1024)
+
+enum { B_MALLOC, B_MMAP, B_POPULATE, B_THP, B_COUNT };
+static const char *backing_name[] = { "malloc", "mmap", "populate", "thp" };
+
+enum { P_SEQ_READ, P_SEQ_WRITE, P_RAND_READ, P_RAND_WRITE, P_STRIDE_READ, P_STRIDE_WRITE, P_COUNT };
+static const char *pattern_name[] = { "seq-read", "seq-write", "rand-read", "rand-write", "stride-read", "stride-write" };
+
+typedef struct {
+	long minflt, majflt;
+	double sec;
+	long rss_kb, private_kb;    // 접근 뒤 RSS, 그중 이 프로세스 혼자 가진 부분
+} result;
+
+typedef struct {
+	char *base;                 // 실제로 해제할 주소
+	char *data;                 // 정렬된 시작 주소
+	size_t map_len;
+	int backing;
+} buffer;
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void get_faults(long *minflt, long *majflt){
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	*minflt = usage.ru_minflt;
+	*majflt = usage.ru_majflt;
+}
+
+/* /proc/self/smaps 에서 [addr, addr+len) 과 겹치는 영역들의 Rss 와 Private_Clean + Private_Dirty (kB).
+ * 프로세스 전체가 아니라 버퍼가 들어 있는 매핑만 센다 */
+static void get_rss(const char *addr, size_t len, long *rss_kb, long *private_kb){
+	FILE *fp = fopen("/proc/self/smaps", "r");
+	unsigned long lo = (unsigned long)addr, hi = lo + len, start, end;
+	char line[512];
+	int in = 0;
+	long v;
+
+	*rss_kb = *private_kb = 0;
+	if(fp == NULL)
+		return;
+	while(fgets(line, sizeof(line), fp)){
+		if(sscanf(line, "%lx-%lx ", &start, &end) == 2 && strchr(line, '-') < strchr(line, ' ')){
+			in = start < hi && end > lo;
+			continue;
+		}
+		if(!in)
+			continue;
+		if(sscanf(line, "Rss: %ld", &v) == 1) *rss_kb += v;
+		else if(sscanf(line, "Private_Clean: %ld", &v) == 1) *private_kb += v;
+		else if(sscanf(line, "Private_Dirty: %ld", &v) == 1) *private_kb += v;
+	}
+	fclose(fp);
+}
+
+static int buffer_alloc(buffer *b, size_t size, int backing){
+	b->backing = backing;
+	b->map_len = size;
+	switch(backing){
+	case B_MALLOC:
+		b->base = b->data = malloc(size);
+		return b->data ? 0 : -1;
+	case B_MMAP:
+	case B_POPULATE:
+		b->base = mmap(NULL, size, PROT_READ|PROT_WRITE,
+				MAP_PRIVATE|MAP_ANONYMOUS|(backing == B_POPULATE ? MAP_POPULATE : 0), -1, 0);
+		b->data = b->base;
+		return b->base == MAP_FAILED ? -1 : 0;
+	case B_THP:
+		// 2 MB 경계에 맞춰야 huge page 로 채워진다
+		b->map_len = size + HUGE_SIZE;
+		b->base = mmap(NULL, b->map_len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+		if(b->base == MAP_FAILED)
+			return -1;
+		b->data = (char *)(((unsigned long)b->base + HUGE_SIZE - 1) & ~(unsigned long)(HUGE_SIZE - 1));
+		if(madvise(b->data, size, MADV_HUGEPAGE) == -1)
+			perror("madvise(MADV_HUGEPAGE)");
+		return 0;
+	}
+	return -1;
+}
+
+static void buffer_free(buffer *b){
+	if(b->backing == B_MALLOC)
+		free(b->base);
+	else
+		munmap(b->base, b->map_len);
+}
+
+/* 패턴대로 페이지마다 한 바이트씩 읽거나 쓴다. order 는 랜덤 패턴용 페이지 순서 */
+static void touch(char *data, size_t npages, int pattern, const size_t *order, size_t stride){
+	volatile char tmp;
+	size_t i;
+
+	switch(pattern){
+	case P_SEQ_READ:
+		for(i = 0; i < npages; i++) tmp = data[i * PAGE_SIZE];
+		break;
+	case P_SEQ_WRITE:
+		for(i = 0; i < npages; i++) data[i * PAGE_SIZE] = 2;
+		break;
+	case P_RAND_READ:
+		for(i = 0; i < npages; i++) tmp = data[order[i] * PAGE_SIZE];
+		break;
+	case P_RAND_WRITE:
+		for(i = 0; i < npages; i++) data[order[i] * PAGE_SIZE] = 2;
+		break;
+	case P_STRIDE_READ:
+		for(i = 0; i < npages; i += stride) tmp = data[i * PAGE_SIZE];
+		break;
+	case P_STRIDE_WRITE:
+		for(i = 0; i < npages; i += stride) data[i * PAGE_SIZE] = 2;
+		break;
+	}
+	(void)tmp;
+}
+
+static void measure(result *r, char *data, size_t npages, int pattern, const size_t *order, size_t stride){
+	long min0, maj0;
+	double t0;
+
+	get_faults(&min0, &maj0);
+	t0 = now_sec();
+	touch(data, npages, pattern, order, stride);
+	r->sec = now_sec() - t0;
+	get_faults(&r->minflt, &r->majflt);
+	r->minflt -= min0;
+	r->majflt -= maj0;
+	get_rss(data, npages * PAGE_SIZE, &r->rss_kb, &r->private_kb);
+}
+
+static void print_row(const char *mode, int backing, size_t size, int pattern, const result *r,
+		double fork_ms, long rss_before_kb){
+	long faults = r->minflt + r->majflt;
+
+	printf("%-9s %8zu %-12s %-5s %9ld %6ld", backing_name[backing], size >> 20,
+			pattern_name[pattern], mode, r->minflt, r->majflt);
+	// 폴트가 거의 없으면 폴트당 시간은 의미가 없다
+	if(faults >= 16)
+		printf(" %10.0f %9.2f", r->sec * 1e9 / faults, r->sec * 1e3);
+	else
+		printf(" %10s %9.2f", "-", r->sec * 1e3);
+	if(fork_ms >= 0)
+		printf(" %8.2f %9ld %9ld %9ld\n", fork_ms, rss_before_kb >> 10, r->rss_kb >> 10, r->private_kb >> 10);
+	else
+		printf(" %8s %9s %9ld %9ld\n", "-", "-", r->rss_kb >> 10, r->private_kb >> 10);
+	fflush(stdout);
+}
+
+static void run(size_t size, int backing, int pattern, const size_t *order, size_t stride){
+	size_t npages = size / PAGE_SIZE;
+	buffer b;
+	result r;
+	int fd[2];
+	long rss_before, priv;
+	double t0, fork_ms;
+	pid_t pid;
+
+	// fresh: 처음 건드리는 비용. malloc 은 앞에서 free 한 힙을 다시 줄 수 있어
+	// (glibc 의 동적 mmap 임계값) 폴트가 0 으로 나올 수 있다
+	if(buffer_alloc(&b, size, backing) == -1){
+		perror("alloc");
+		return;
+	}
+	measure(&r, b.data, npages, pattern, order, stride);
+	print_row("fresh", backing, size, pattern, &r, -1, 0);
+
+	// cow: 부모가 모든 페이지를 쓴 뒤 fork
+	memset(b.data, 1, size);
+	get_rss(b.data, size, &rss_before, &priv);
+	pipe(fd);
+	t0 = now_sec();
+	pid = fork();
+	if(pid == 0){
+		close(fd[0]);
+		measure(&r, b.data, npages, pattern, order, stride);
+		write(fd[1], &r, sizeof(r));
+		_exit(0);
+	}
+	fork_ms = (now_sec() - t0) * 1e3;
+	close(fd[1]);
+	if(read(fd[0], &r, sizeof(r)) == sizeof(r))
+		print_row("cow", backing, size, pattern, &r, fork_ms, rss_before);
+	close(fd[0]);
+	waitpid(pid, NULL, 0);
+	buffer_free(&b);
+}
+
+/* "a,b,c" 를 이름 표에서 찾아 flags 로 */
+static unsigned parse_names(char *arg, const char **names, int count){
+	unsigned mask = 0;
+
+	for(char *tok = strtok(arg, ","); tok; tok = strtok(NULL, ",")){
+		int i;
+		for(i = 0; i < count; i++)
+			if(strcmp(tok, names[i]) == 0)
+				break;
+		if(i == count){
+			fprintf(stderr, "unknown name: %s\n", tok);
+			exit(1);
+		}
+		mask |= 1u << i;
+	}
+	return mask;
+}
+
+int main(int argc, char *argv[]){
+	size_t sizes[16] = { 16, 64, 256 };
+	int nsizes = 3, opt;
+	unsigned backings = (1u << B_COUNT) - 1, patterns = (1u << P_COUNT) - 1;
+	size_t stride = 16, max_pages = 0, *order;
+
+	while((opt = getopt(argc, argv, "s:b:p:t:")) != -1){
+		if(opt == 's'){
+			nsizes = 0;
+			for(char *tok = strtok(optarg, ","); tok && nsizes < 16; tok = strtok(NULL, ",")){
+				char *end;
+				errno = 0;
+				sizes[nsizes] = strtoull(tok, &end, 10);
+				// 한 페이지도 안 되는 크기(0)면 아래 섞기에서 npages - 1 이 넘친다
+				if(end == tok || *end != '\0' || errno == ERANGE || sizes[nsizes] == 0
+						|| sizes[nsizes] > (SIZE_MAX >> 20) / 2){
+					fprintf(stderr, "bad size: %s (MB, at least 1)\n", tok);
+					exit(1);
+				}
+				nsizes++;
+			}
+			if(nsizes == 0){
+				fprintf(stderr, "bad size list\n");
+				exit(1);
+			}
+		} else if(opt == 'b') backings = parse_names(optarg, backing_name, B_COUNT);
+		else if(opt == 'p') patterns = parse_names(optarg, pattern_name, P_COUNT);
+		else if(opt == 't') stride = strtoull(optarg, NULL, 10);
+		else {
+			fprintf(stderr, "Usage : %s [-s MB,..] [-b malloc,mmap,populate,thp] "
+					"[-p seq-read,seq-write,rand-read,rand-write,stride-read,stride-write] [-t stride_pages]\n", argv[0]);
+			exit(1);
+		}
+	}
+	if(stride == 0)
+		stride = 1;
+
+	// 랜덤 패턴용 페이지 순서 배열은 가장 큰 크기에 맞춰 잡고, 크기마다 다시 섞는다 (Fisher-Yates)
+	for(int i = 0; i < nsizes; i++){
+		sizes[i] <<= 20;
+		if(sizes[i] / PAGE_SIZE > max_pages)
+			max_pages = sizes[i] / PAGE_SIZE;
+	}
+	order = malloc(sizeof(size_t) * max_pages);
+	srand(1);
+
+	printf("%-9s %8s %-12s %-5s %9s %6s %10s %9s %8s %9s %9s %9s\n", "backing", "MB", "pattern", "mode",
+			"minflt", "majflt", "ns/fault", "ms", "fork_ms", "rss0_MB", "rss_MB", "priv_MB");
+	for(int s = 0; s < nsizes; s++){
+		size_t npages = sizes[s] / PAGE_SIZE;
+
+		for(size_t i = 0; i < npages; i++)
+			order[i] = i;
+		for(size_t i = npages - 1; i > 0; i--){
+			size_t j = ((size_t)rand() * RAND_MAX + rand()) % (i + 1), t = order[i];
+			order[i] = order[j];
+			order[j] = t;
+		}
+		for(int b = 0; b < B_COUNT; b++)
+			for(int p = 0; p < P_COUNT; p++)
+				if((backings >> b & 1) && (patterns >> p & 1))
+					run(sizes[s], b, p, order, stride);
+	}
+	free(order);
+	return 0;
+}
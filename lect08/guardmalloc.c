@@ -0,0 +1,450 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <dlfcn.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+/* LD_PRELOAD 로 붙이는 guard page 디버그 할당기.
+ * mem_leak.c 의 arr[10] (10 개짜리 배열 뒤에 쓰기) 와 mem_leak_02.c 의 free 뒤 읽기는
+ * 보통 malloc 에서는 아무 일 없이 지나간다. 여기서는 할당 중 일부(1/RATE)만 골라
+ *   - 객체 끝을 PROT_NONE 페이지 바로 앞에 붙여 넘치는 순간 SIGSEGV 가 나게 하고
+ *   - free 한 페이지는 PROT_NONE 으로 바꿔 격리(quarantine)해 두어 다시 읽으면 SIGSEGV 가 나게 한다.
+ * 폴트가 나면 종류(overflow/underflow/use-after-free), 할당/해제 때의 스택, 폴트 난 곳의 스택을
+ * stderr 에 찍고 기본 동작(코어 덤프)으로 죽는다. 나머지 할당은 glibc 그대로라 비용은 RATE 로 조절한다.
+ *
+ * 환경 변수
+ *   GUARDMALLOC_RATE        N 번에 한 번꼴로 guard 할당 (기본 5000, 1 이면 전부, 0 이면 끔)
+ *   GUARDMALLOC_MAX         이보다 큰 요청은 고르지 않는다 (기본 16384 바이트)
+ *   GUARDMALLOC_SLOTS       동시에 가질 수 있는 guard 할당 수 (기본 16384)
+ *   GUARDMALLOC_QUARANTINE  free 뒤 재사용하지 않고 잡아 둘 개수 (기본 SLOTS / 4)
+ *   GUARDMALLOC_VERBOSE     1 이면 끝날 때 통계 출력
+ * guard 할당 하나에 mprotect/madvise 와 backtrace 두 번씩, 대략 10~20 us 가 든다. malloc/free 만 도는
+ * alloc_bench 에서도 RATE 5000 이면 차이가 측정 잡음 수준이다.
+ * 사용법: LD_PRELOAD=./guardmalloc.so GUARDMALLOC_RATE=1 ./mem_leak */
+
+#define PAGE_SIZE 4096
+#define MAX_FRAMES 16
+
+enum { S_EMPTY, S_LIVE, S_FREED };
+
+/* guard 할당 하나의 기록. 페이지 밖(별도 배열)에 두어 객체 앞뒤를 모두 PROT_NONE 으로 둘 수 있다 */
+typedef struct {
+	int state;
+	int nalloc, nfree;
+	pid_t alloc_tid, free_tid;
+	char *obj;
+	size_t size;
+	void *alloc_bt[MAX_FRAMES];
+	void *free_bt[MAX_FRAMES];
+} slot_meta;
+
+/* 슬롯 하나 = 데이터 페이지 max_pages 개 + guard 페이지 1 개.
+ * 객체는 데이터 영역 끝(guard 바로 앞)에 붙이고, 쓰는 페이지만 읽기/쓰기로 연다 */
+static char *pool_lo, *pool_hi;
+static size_t pool_span;
+static size_t slot_size, max_pages, max_size = 16384;
+static long nslots = 16384, qcap = -1;
+static slot_meta *meta;
+static int *free_stack, *quarantine;
+static long free_top, q_head, q_len;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static long rate = 5000;
+static int verbose;
+static volatile int inited;
+static long n_sampled, n_fallback;
+static struct sigaction old_segv;
+static size_t (*next_usable_size)(void *);
+
+extern void *__libc_malloc(size_t);
+extern void __libc_free(void *);
+extern void *__libc_calloc(size_t, size_t);
+extern void *__libc_realloc(void *, size_t);
+extern void *__libc_memalign(size_t, size_t);
+extern void *__libc_valloc(size_t);
+extern void *__libc_pvalloc(size_t);
+
+/* 정적 TLS 로 두어야 스레드가 처음 쓸 때 malloc 이 불리지 않는다 */
+static __thread int in_hook __attribute__((tls_model("initial-exec")));
+static __thread long countdown __attribute__((tls_model("initial-exec")));
+static __thread unsigned long seed __attribute__((tls_model("initial-exec")));
+
+static void segv_handler(int signo, siginfo_t *si, void *uc);
+
+static long env_long(const char *name, long def){
+	const char *v = getenv(name);
+	return v && *v ? atol(v) : def;
+}
+
+static void init(void){
+	struct sigaction sa;
+	void *bt[1];
+
+	// backtrace/dlsym 이 안에서 부르는 malloc 은 그냥 glibc 로 보낸다
+	if(inited || in_hook)
+		return;
+	in_hook = 1;
+	pthread_mutex_lock(&lock);
+	if(inited){
+		pthread_mutex_unlock(&lock);
+		in_hook = 0;
+		return;
+	}
+	rate = env_long("GUARDMALLOC_RATE", rate);
+	max_size = env_long("GUARDMALLOC_MAX", max_size);
+	nslots = env_long("GUARDMALLOC_SLOTS", nslots);
+	qcap = env_long("GUARDMALLOC_QUARANTINE", nslots / 4);
+	verbose = env_long("GUARDMALLOC_VERBOSE", 0);
+	if(nslots < 1 || max_size < 1)
+		rate = 0;
+	if(qcap >= nslots)
+		qcap = nslots - 1;
+	if(qcap < 0)
+		qcap = 0;
+
+	max_pages = (max_size + PAGE_SIZE - 1) / PAGE_SIZE;
+	slot_size = (max_pages + 1) * PAGE_SIZE;
+	if(rate > 0){
+		// 주소 공간만 잡아 두고(PROT_NONE, 예약 없음) 쓰는 페이지만 연다
+		pool_lo = mmap(NULL, slot_size * nslots, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+		meta = mmap(NULL, sizeof(slot_meta) * nslots + sizeof(int) * (nslots + qcap + 1),
+				PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+		if(pool_lo == MAP_FAILED || meta == MAP_FAILED){
+			rate = 0;
+			pool_lo = NULL;
+		} else {
+			pool_hi = pool_lo + slot_size * nslots;
+			pool_span = slot_size * nslots;
+			free_stack = (int *)(meta + nslots);
+			quarantine = free_stack + nslots;
+			for(long i = 0; i < nslots; i++)
+				free_stack[i] = nslots - 1 - i;
+			free_top = nslots;
+
+			memset(&sa, 0, sizeof(sa));
+			sa.sa_sigaction = segv_handler;
+			sa.sa_flags = SA_SIGINFO|SA_NODEFER;
+			sigaction(SIGSEGV, &sa, &old_segv);
+		}
+	}
+	// backtrace 는 처음 불릴 때 libgcc_s 를 올리느라 malloc 을 부르므로 여기서 미리 한 번
+	backtrace(bt, 1);
+	next_usable_size = (size_t (*)(void *))dlsym(RTLD_NEXT, "malloc_usable_size");
+	inited = 1;
+	pthread_mutex_unlock(&lock);
+	in_hook = 0;
+}
+
+/* 빼기 한 번과 비교 한 번. 풀이 없으면 pool_span 이 0 이라 항상 거짓 */
+static inline int in_pool(const void *p){
+	return (uintptr_t)p - (uintptr_t)pool_lo < pool_span;
+}
+
+/* 다음 간격을 [1, 2*rate) 에서 고르게 뽑는다 (할당 주기와 맞물리지 않게) */
+static long next_interval(void){
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return rate == 1 ? 1 : 1 + seed % (2 * rate - 1);
+}
+
+/* 카운터가 0 이 되었을 때: 처음이면 초기화하고 다음 간격을 뽑는다.
+ * 스레드의 카운터는 0 에서 시작하므로, 그 스레드의 첫 호출은 고르지 않고 간격만 정한다
+ * (안 그러면 짧게 사는 스레드가 많을 때 실제 비율이 1/rate 보다 훨씬 높아진다) */
+static int sample_slow(size_t size){
+	if(!inited)
+		init();
+	if(in_hook || !inited){
+		countdown = 1;          // 초기화 도중이거나 backtrace 안: 다음 호출에서 다시 본다
+		return 0;
+	}
+	if(rate <= 0){
+		countdown = LONG_MAX;
+		return 0;
+	}
+	if(seed == 0){
+		seed = ((unsigned long)&seed ^ (unsigned long)syscall(SYS_gettid) << 17) | 1;
+		if(rate > 1){
+			countdown = next_interval();
+			return 0;
+		}
+	}
+	countdown = next_interval();
+	return size <= max_size;
+}
+
+/* 평균 rate 번에 한 번. 고르지 않는 대부분의 호출은 스레드 카운터 하나만 줄이고 glibc 로 간다 */
+static inline int should_sample(size_t size){
+	if(__builtin_expect(--countdown > 0, 1))
+		return 0;
+	return sample_slow(size);
+}
+
+/* guard 슬롯에서 size 바이트. 정렬은 그 크기의 객체에 필요한 만큼만 (8~16) 맞춰서
+ * 40 바이트 요청이면 8 정렬로 guard 에 딱 붙는다. 슬롯이 없으면 NULL */
+static void *guard_alloc(size_t size, size_t align){
+	size_t npages, need = size ? size : 1;
+	long idx;
+	char *guard;
+	slot_meta *m;
+
+	if(align == 0){
+		align = need & -need;
+		if(align > 16)
+			align = 16;
+		if(align < 8)
+			align = 8;
+	}
+	pthread_mutex_lock(&lock);
+	if(free_top == 0){
+		n_fallback++;
+		pthread_mutex_unlock(&lock);
+		return NULL;
+	}
+	idx = free_stack[--free_top];
+	n_sampled++;
+	pthread_mutex_unlock(&lock);
+
+	m = &meta[idx];
+	guard = pool_lo + idx * slot_size + max_pages * PAGE_SIZE;
+	m->obj = (char *)((uintptr_t)(guard - need) & ~(uintptr_t)(align - 1));
+	npages = (guard - m->obj + PAGE_SIZE - 1) / PAGE_SIZE;
+	if(mprotect(guard - npages * PAGE_SIZE, npages * PAGE_SIZE, PROT_READ|PROT_WRITE) == -1){
+		pthread_mutex_lock(&lock);
+		free_stack[free_top++] = idx;
+		pthread_mutex_unlock(&lock);
+		return NULL;
+	}
+	m->size = size;
+	m->alloc_tid = syscall(SYS_gettid);
+	in_hook = 1;
+	m->nalloc = backtrace(m->alloc_bt, MAX_FRAMES);
+	in_hook = 0;
+	m->nfree = 0;
+	m->state = S_LIVE;
+	return m->obj;
+}
+
+static void report(const char *what, const void *addr, long idx, int with_here);
+
+static void guard_free(void *p){
+	long idx = ((char *)p - pool_lo) / slot_size, old = -1;
+	slot_meta *m = &meta[idx];
+	char *data = pool_lo + idx * slot_size;
+
+	if(m->state != S_LIVE || m->obj != p){
+		report(m->state == S_FREED ? "double-free" : "invalid-free", p, idx, 1);
+		abort();
+	}
+	m->free_tid = syscall(SYS_gettid);
+	in_hook = 1;
+	m->nfree = backtrace(m->free_bt, MAX_FRAMES);
+	in_hook = 0;
+	m->state = S_FREED;
+	// 내용을 버리고 막아 둔다. 격리가 차면 가장 오래된 슬롯을 다시 쓸 수 있게 돌린다
+	madvise(data, max_pages * PAGE_SIZE, MADV_DONTNEED);
+	mprotect(data, max_pages * PAGE_SIZE, PROT_NONE);
+
+	pthread_mutex_lock(&lock);
+	if(qcap == 0){
+		old = idx;
+	} else {
+		if(q_len == qcap){
+			old = quarantine[q_head];
+			q_head = (q_head + 1) % qcap;
+			q_len--;
+		}
+		quarantine[(q_head + q_len) % qcap] = idx;
+		q_len++;
+	}
+	if(old >= 0){
+		meta[old].state = S_EMPTY;
+		free_stack[free_top++] = old;
+	}
+	pthread_mutex_unlock(&lock);
+}
+
+/* ---- 보고 (시그널 핸들러에서도 불리므로 malloc 을 쓰지 않는다) ---- */
+
+static void say(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void say(const char *fmt, ...){
+	char buf[256];
+	va_list ap;
+	int n;
+
+	va_start(ap, fmt);
+	n = vsnprintf(buf, sizeof(buf), fmt, ap);
+	va_end(ap);
+	if(n > (int)sizeof(buf) - 1)
+		n = sizeof(buf) - 1;
+	if(n > 0)
+		write(STDERR_FILENO, buf, n);
+}
+
+static void report(const char *what, const void *addr, long idx, int with_here){
+	slot_meta *m = &meta[idx];
+	void *here[MAX_FRAMES];
+	long off = (const char *)addr - m->obj;
+
+	say("==guardmalloc== %s at %p: %ld bytes %s %zu-byte object %p\n", what, addr,
+			off < 0 ? -off : off >= (long)m->size ? off - (long)m->size : off,
+			off < 0 ? "before" : off >= (long)m->size ? "after" : "inside", m->size, (void *)m->obj);
+	if(with_here){
+		say("==guardmalloc== access:\n");
+		backtrace_symbols_fd(here, backtrace(here, MAX_FRAMES), STDERR_FILENO);
+	}
+	say("==guardmalloc== allocated by thread %d:\n", m->alloc_tid);
+	backtrace_symbols_fd(m->alloc_bt, m->nalloc, STDERR_FILENO);
+	if(m->state == S_FREED){
+		say("==guardmalloc== freed by thread %d:\n", m->free_tid);
+		backtrace_symbols_fd(m->free_bt, m->nfree, STDERR_FILENO);
+	}
+}
+
+static void segv_handler(int signo, siginfo_t *si, void *uc){
+	char *addr = si->si_addr;
+
+	if(in_pool(addr)){
+		long idx = (addr - pool_lo) / slot_size;
+		char *guard = pool_lo + idx * slot_size + max_pages * PAGE_SIZE;
+		const char *what;
+
+		if(meta[idx].state == S_FREED)
+			what = "use-after-free";
+		else if(meta[idx].state == S_EMPTY)
+			what = "wild access to unused guard slot";
+		else if(addr >= guard)
+			what = "heap-buffer-overflow";
+		else
+			what = "heap-buffer-underflow";
+		report(what, addr, idx, 1);
+		// 기본 동작으로 되돌리고 돌아가면 같은 명령이 다시 폴트 나서 코어를 남기고 죽는다
+		signal(SIGSEGV, SIG_DFL);
+		return;
+	}
+	// 우리 것이 아니면 원래 핸들러에게
+	if(old_segv.sa_flags & SA_SIGINFO && old_segv.sa_sigaction){
+		old_segv.sa_sigaction(signo, si, uc);
+	} else if(old_segv.sa_handler != SIG_DFL && old_segv.sa_handler != SIG_IGN){
+		old_segv.sa_handler(signo);
+	} else {
+		signal(SIGSEGV, SIG_DFL);
+	}
+}
+
+__attribute__((destructor)) static void fini(void){
+	if(verbose && inited)
+		say("==guardmalloc== rate 1/%ld, %ld guarded allocations, %ld skipped (slots full), "
+				"%ld quarantined\n", rate, n_sampled, n_fallback, q_len);
+}
+
+/* ---- 바꿔 끼우는 함수들 ---- */
+
+void *malloc(size_t size){
+	void *p;
+
+	if(should_sample(size) && (p = guard_alloc(size, 0)) != NULL)
+		return p;
+	return __libc_malloc(size);
+}
+
+void free(void *p){
+	if(p == NULL)
+		return;
+	if(in_pool(p))
+		guard_free(p);
+	else
+		__libc_free(p);
+}
+
+void *calloc(size_t n, size_t size){
+	size_t total;
+	void *p;
+
+	if(__builtin_mul_overflow(n, size, &total)){
+		errno = ENOMEM;
+		return NULL;
+	}
+	// guard 슬롯은 DONTNEED 로 비운 새 페이지라 이미 0
+	if(should_sample(total) && (p = guard_alloc(total, 0)) != NULL)
+		return p;
+	return __libc_calloc(n, size);
+}
+
+void *realloc(void *old, size_t size){
+	size_t old_size;
+	void *p;
+
+	if(old == NULL)
+		return malloc(size);
+	if(size == 0){
+		free(old);
+		return NULL;
+	}
+	if(!in_pool(old)){
+		if(!should_sample(size))
+			return __libc_realloc(old, size);
+		if((p = guard_alloc(size, 0)) == NULL)
+			return __libc_realloc(old, size);
+		old_size = next_usable_size ? next_usable_size(old) : size;
+	} else {
+		long idx = ((char *)old - pool_lo) / slot_size;
+		old_size = meta[idx].size;
+		if((p = malloc(size)) == NULL)
+			return NULL;
+	}
+	memcpy(p, old, old_size < size ? old_size : size);
+	free(old);
+	return p;
+}
+
+void *memalign(size_t align, size_t size){
+	void *p;
+
+	if(align <= PAGE_SIZE && should_sample(size) && (p = guard_alloc(size, align < 16 ? 16 : align)) != NULL)
+		return p;
+	return __libc_memalign(align, size);
+}
+
+void *aligned_alloc(size_t align, size_t size){
+	return memalign(align, size);
+}
+
+int posix_memalign(void **out, size_t align, size_t size){
+	void *p;
+
+	if(align < sizeof(void *) || (align & (align - 1)))
+		return EINVAL;
+	if((p = memalign(align, size)) == NULL)
+		return ENOMEM;
+	*out = p;
+	return 0;
+}
+
+void *valloc(size_t size){
+	return __libc_valloc(size);
+}
+
+void *pvalloc(size_t size){
+	return __libc_pvalloc(size);
+}
+
+size_t malloc_usable_size(void *p){
+	if(p == NULL)
+		return 0;
+	if(in_pool(p))
+		return meta[((char *)p - pool_lo) / slot_size].size;
+	if(!inited)
+		init();
+	return next_usable_size ? next_usable_size(p) : 0;
+}
@@ -0,0 +1,572 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <pthread.h>
+#include <execinfo.h>
+#include <stdatomic.h>
+#include <dlfcn.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+
+/* LD_PRELOAD 로 붙이는 샘플링 힙 프로파일러.
+ * 할당한 바이트 수로 샘플을 고른다: 평균 RATE 바이트마다(지수 분포 간격) 한 번 걸린 할당의
+ * 호출 스택을 기록하고, 걸릴 확률 1 - exp(-size/RATE) 로 나눠 전체 양을 추정한다.
+ * 호출 위치(스택)마다 살아 있는 바이트/개수, 할당 속도, 오래 살아 있는 것(누수 후보)을 모아서
+ * 주기적으로, 그리고 끝날 때 보고서를 쓴다.
+ *   text      : 위치별 표 + 누수 후보 (사람이 읽는 것)
+ *   pprof     : gperftools 힙 프로파일 형식 (heap_v2). pprof <실행 파일> <파일> 로 본다
+ *   collapsed : flamegraph.pl 입력 ("바깥;...;안쪽 살아 있는 바이트")
+ *
+ * 환경 변수
+ *   HEAPPROF_RATE      평균 샘플 간격 바이트 (기본 524288, 1 이면 모든 할당 = 정확한 누수 검사)
+ *   HEAPPROF_OUT       출력 파일 앞부분 (기본 heapprof.<pid>), 뒤에 .<번호>|.final 과 형식별 확장자
+ *   HEAPPROF_FORMAT    text,pprof,collapsed 중 쉼표로 여럿 (기본 text)
+ *   HEAPPROF_INTERVAL  주기 보고 간격 초 (기본 0 = 끝날 때만). 샘플이 걸릴 때 확인한다
+ *   HEAPPROF_LEAK_AGE  이 초보다 오래 살아 있는 것을 주기 보고에서 누수 후보로 (기본 10)
+ * 사용법: LD_PRELOAD=./heapprof.so HEAPPROF_RATE=1 ./mem_layout.exe && cat heapprof.*.final.txt */
+
+#define MAX_FRAMES 32
+#define MAX_STACKS 8192             // 서로 다른 호출 위치 수 (2 의 거듭제곱)
+#define MAX_LIVE (1 << 18)          // 동시에 살아 있는 샘플 수 (2 의 거듭제곱)
+#define TOP_SITES 30
+
+enum { F_TEXT = 1, F_PPROF = 2, F_COLLAPSED = 4 };
+
+/* 호출 위치 하나의 누적 값. est_ 는 샘플 확률로 나눈 추정치, 나머지는 샘플 그대로 */
+typedef struct {
+	uint64_t hash;
+	int depth;
+	void *frames[MAX_FRAMES];
+	long allocs, frees;                 // 샘플 수
+	size_t bytes;                       // 샘플 바이트 합 (pprof heap_v2 용)
+	long live, live_bytes;              // 살아 있는 샘플
+	double est_allocs, est_bytes;       // 지금까지 할당 추정
+	double est_live, est_live_bytes;    // 살아 있는 것 추정
+} site;
+
+/* 살아 있는 샘플 하나. ptr 이 0 이면 빈칸, TOMB 이면 지워진 칸.
+ * 지워진 칸이 MAX_LIVE / 8 을 넘으면 다른 표로 옮겨 담아 (rebuild) 탐색 길이를 되돌린다.
+ * free 는 잠금 없이 표를 훑으므로 옮기는 동안 live_gen 을 바꿔서, 못 찾았는데 세대가 바뀌었으면 잠금을 잡고 다시 찾는다 */
+typedef struct {
+	_Atomic(uintptr_t) ptr;
+	int site;
+	size_t size;
+	double weight;                      // 이 샘플이 대표하는 할당 수 (1/p)
+	double t_alloc;
+} live_ent;
+
+#define TOMB ((uintptr_t)1)
+
+static site *sites;
+static live_ent *_Atomic live;
+static live_ent *live_spare;            // rebuild 때 옮겨 담을 표
+static _Atomic unsigned live_gen;
+static long nsites, nlive, ntomb;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double rate = 524288;
+static int formats = F_TEXT;
+static double interval, leak_age = 10, t_start, next_dump;
+static char out_prefix[256];
+static int dump_seq;
+static long dropped;                    // 표가 차서 버린 샘플
+static volatile int inited;
+static void *self_base;                 // 이 .so 의 시작 주소 (스택에서 우리 프레임을 뺄 때)
+
+extern void *__libc_malloc(size_t);
+extern void __libc_free(void *);
+extern void *__libc_calloc(size_t, size_t);
+extern void *__libc_realloc(void *, size_t);
+extern void *__libc_memalign(size_t, size_t);
+
+static __thread int in_hook __attribute__((tls_model("initial-exec")));
+static __thread double until_sample __attribute__((tls_model("initial-exec")));
+static __thread unsigned long seed __attribute__((tls_model("initial-exec")));
+
+static double now_sec(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 다음 샘플까지의 바이트: 평균 rate 인 지수 분포 */
+static double next_interval(void){
+	double u;
+
+	if(rate <= 1)
+		return 0;
+	if(seed == 0)
+		seed = ((unsigned long)&seed * 0x9e3779b97f4a7c15UL) | 1;
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	u = ((seed >> 11) + 1) * (1.0 / 9007199254740993.0);    // (0, 1]
+	return -log(u) * rate;
+}
+
+static void init(void){
+	const char *v;
+	Dl_info info;
+
+	if(inited || in_hook)
+		return;
+	in_hook = 1;
+	pthread_mutex_lock(&lock);
+	if(!inited){
+		void *bt[1];
+
+		if((v = getenv("HEAPPROF_RATE")) && *v)
+			rate = atof(v);
+		if((v = getenv("HEAPPROF_INTERVAL")) && *v)
+			interval = atof(v);
+		if((v = getenv("HEAPPROF_LEAK_AGE")) && *v)
+			leak_age = atof(v);
+		if((v = getenv("HEAPPROF_FORMAT")) && *v){
+			formats = 0;
+			if(strstr(v, "text")) formats |= F_TEXT;
+			if(strstr(v, "pprof")) formats |= F_PPROF;
+			if(strstr(v, "collapsed")) formats |= F_COLLAPSED;
+		}
+		if((v = getenv("HEAPPROF_OUT")) && *v)
+			snprintf(out_prefix, sizeof(out_prefix), "%s", v);
+		else
+			snprintf(out_prefix, sizeof(out_prefix), "heapprof.%d", getpid());
+
+		sites = mmap(NULL, sizeof(site) * MAX_STACKS, PROT_READ|PROT_WRITE,
+				MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+		live = mmap(NULL, sizeof(live_ent) * MAX_LIVE, PROT_READ|PROT_WRITE,
+				MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+		live_spare = mmap(NULL, sizeof(live_ent) * MAX_LIVE, PROT_READ|PROT_WRITE,
+				MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+		if(sites == MAP_FAILED || live == MAP_FAILED || live_spare == MAP_FAILED){
+			sites = NULL;
+			live = NULL;
+		}
+		if(dladdr((void *)init, &info))
+			self_base = info.dli_fbase;
+		backtrace(bt, 1);       // libgcc_s 를 미리 올린다 (처음에 malloc 을 부름)
+		t_start = now_sec();
+		next_dump = interval > 0 ? t_start + interval : INFINITY;
+		inited = 1;
+	}
+	pthread_mutex_unlock(&lock);
+	in_hook = 0;
+}
+
+static uint64_t hash_ptr(uintptr_t p){
+	p ^= p >> 33;
+	p *= 0xff51afd7ed558ccdULL;
+	p ^= p >> 33;
+	return p;
+}
+
+/* 스택을 찾거나 새로 넣는다 (lock 을 잡고 부를 것). 표가 차면 -1 */
+static int site_get(void **frames, int depth){
+	uint64_t h = 14695981039346656037ULL;
+
+	for(int i = 0; i < depth; i++)
+		h = (h ^ (uintptr_t)frames[i]) * 1099511628211ULL;
+	if(h == 0)
+		h = 1;
+	for(uint64_t i = h & (MAX_STACKS - 1), n = 0; n < MAX_STACKS; i = (i + 1) & (MAX_STACKS - 1), n++){
+		site *s = &sites[i];
+		if(s->hash == 0){
+			if(nsites >= MAX_STACKS * 3 / 4)
+				return -1;
+			s->hash = h;
+			s->depth = depth;
+			memcpy(s->frames, frames, sizeof(void *) * depth);
+			nsites++;
+			return i;
+		}
+		if(s->hash == h && s->depth == depth && memcmp(s->frames, frames, sizeof(void *) * depth) == 0)
+			return i;
+	}
+	return -1;
+}
+
+static void dump(const char *tag);
+
+/* 빈칸(0)이나 지워진 칸을 찾아 p 의 자리로. nlive + ntomb 가 MAX_LIVE 보다 작으므로 반드시 있다 (lock 을 잡은 채) */
+static live_ent *live_slot(live_ent *tab, uintptr_t p){
+	uint64_t i = hash_ptr(p) & (MAX_LIVE - 1);
+	uintptr_t k;
+
+	while((k = atomic_load_explicit(&tab[i].ptr, memory_order_relaxed)) > TOMB)
+		i = (i + 1) & (MAX_LIVE - 1);
+	if(k == TOMB)
+		ntomb--;
+	return &tab[i];
+}
+
+/* 지워진 칸을 없애며 다른 표로 옮긴다 (lock 을 잡은 채) */
+static void rebuild(void){
+	live_ent *old = live, *tab = live_spare;
+
+	atomic_fetch_add_explicit(&live_gen, 1, memory_order_release);
+	ntomb = 0;
+	for(long i = 0; i < MAX_LIVE; i++){
+		uintptr_t k = atomic_load_explicit(&old[i].ptr, memory_order_relaxed);
+		live_ent *e;
+		if(k <= TOMB)
+			continue;
+		e = live_slot(tab, k);
+		e->site = old[i].site;
+		e->size = old[i].size;
+		e->weight = old[i].weight;
+		e->t_alloc = old[i].t_alloc;
+		atomic_store_explicit(&e->ptr, k, memory_order_relaxed);
+	}
+	atomic_store_explicit(&live, tab, memory_order_release);
+	atomic_fetch_add_explicit(&live_gen, 1, memory_order_release);
+	// 옛 표는 비워서 다음 rebuild 에 쓴다 (익명 매핑이라 DONTNEED 뒤에는 0 으로 읽힌다)
+	madvise(old, sizeof(live_ent) * MAX_LIVE, MADV_DONTNEED);
+	live_spare = old;
+}
+
+/* p 가 샘플이면 지운다 (lock 을 잡은 채) */
+static void forget_locked(uintptr_t p){
+	live_ent *tab = live;
+	uint64_t i = hash_ptr(p) & (MAX_LIVE - 1);
+	uintptr_t k;
+
+	for(long n = 0; n < MAX_LIVE && (k = atomic_load_explicit(&tab[i].ptr, memory_order_relaxed)) != 0; n++){
+		if(k == p){
+			site *s = &sites[tab[i].site];
+			s->frees++;
+			s->live--;
+			s->live_bytes -= tab[i].size;
+			s->est_live -= tab[i].weight;
+			s->est_live_bytes -= tab[i].weight * tab[i].size;
+			atomic_store_explicit(&tab[i].ptr, TOMB, memory_order_relaxed);
+			nlive--;
+			if(++ntomb > MAX_LIVE / 8)
+				rebuild();
+			return;
+		}
+		i = (i + 1) & (MAX_LIVE - 1);
+	}
+}
+
+/* size 바이트 할당 p 를 샘플로 기록 */
+static void record(void *p, size_t size){
+	void *frames[MAX_FRAMES + 8];
+	int depth, skip = 0, si;
+	double prob, w;
+	Dl_info info;
+
+	in_hook = 1;
+	depth = backtrace(frames, MAX_FRAMES + 8);
+	// 맨 위의 우리 프레임(record, malloc ...)은 뺀다
+	while(skip < depth && dladdr(frames[skip], &info) && info.dli_fbase == self_base)
+		skip++;
+	depth -= skip;
+	if(depth > MAX_FRAMES)
+		depth = MAX_FRAMES;
+
+	// 걸릴 확률로 나눠 이 샘플이 대표하는 할당 수를 구한다
+	prob = rate <= 1 ? 1 : 1 - exp(-(double)(size ? size : 1) / rate);
+	w = 1 / prob;
+
+	pthread_mutex_lock(&lock);
+	if((si = site_get(frames + skip, depth)) < 0 || nlive >= MAX_LIVE * 3 / 4){
+		dropped++;
+	} else {
+		site *s = &sites[si];
+		live_ent *e = live_slot(live, (uintptr_t)p);
+
+		s->allocs++;
+		s->bytes += size;
+		s->live++;
+		s->live_bytes += size;
+		s->est_allocs += w;
+		s->est_bytes += w * size;
+		s->est_live += w;
+		s->est_live_bytes += w * size;
+		e->site = si;
+		e->size = size;
+		e->weight = w;
+		e->t_alloc = now_sec();
+		atomic_store_explicit(&e->ptr, (uintptr_t)p, memory_order_release);
+		nlive++;
+	}
+	pthread_mutex_unlock(&lock);
+	if(now_sec() >= next_dump){
+		pthread_mutex_lock(&lock);
+		if(now_sec() >= next_dump){
+			next_dump += interval;
+			dump(NULL);
+		}
+		pthread_mutex_unlock(&lock);
+	}
+	in_hook = 0;
+}
+
+/* p 가 샘플이면 지운다. 대부분의 free 는 빈칸 하나를 보고 끝난다 (잠금 없음) */
+static void forget(void *p){
+	live_ent *tab;
+	unsigned gen;
+	uint64_t i;
+	uintptr_t k = 0;
+
+	if(live == NULL || nlive == 0)
+		return;
+	gen = atomic_load_explicit(&live_gen, memory_order_acquire);
+	tab = atomic_load_explicit(&live, memory_order_acquire);
+	i = hash_ptr((uintptr_t)p) & (MAX_LIVE - 1);
+	for(long n = 0; n < MAX_LIVE && (k = atomic_load_explicit(&tab[i].ptr, memory_order_acquire)) != 0; n++){
+		if(k == (uintptr_t)p)
+			break;
+		i = (i + 1) & (MAX_LIVE - 1);
+	}
+	atomic_thread_fence(memory_order_acquire);
+	// 찾았거나, 훑는 사이에 표가 옮겨졌으면 잠금을 잡고 지금 표에서 다시
+	if(k == (uintptr_t)p || (gen & 1) || atomic_load_explicit(&live_gen, memory_order_relaxed) != gen){
+		pthread_mutex_lock(&lock);
+		forget_locked((uintptr_t)p);
+		pthread_mutex_unlock(&lock);
+	}
+}
+
+/* 할당 하나마다: 남은 간격에서 size 를 빼고, 0 아래로 내려가면 샘플 */
+static inline void account(void *p, size_t size){
+	if(__builtin_expect((until_sample -= size) > 0, 1) || p == NULL)
+		return;
+	if(!inited)
+		init();
+	if(in_hook || sites == NULL){
+		until_sample = rate;
+		return;
+	}
+	until_sample = next_interval();
+	record(p, size);
+}
+
+/* ---- 보고서 (lock 을 잡은 채 불린다) ---- */
+
+/* 주소를 "함수+0x오프셋" 또는 "라이브러리+0x오프셋" 으로 */
+static void frame_name(void *addr, char *buf, size_t len){
+	Dl_info info;
+
+	if(dladdr(addr, &info) && info.dli_sname)
+		snprintf(buf, len, "%s+0x%lx", info.dli_sname, (unsigned long)((char *)addr - (char *)info.dli_saddr));
+	else if(info.dli_fname)
+		snprintf(buf, len, "%s+0x%lx", strrchr(info.dli_fname, '/') ? strrchr(info.dli_fname, '/') + 1 : info.dli_fname,
+				(unsigned long)((char *)addr - (char *)info.dli_fbase));
+	else
+		snprintf(buf, len, "%p", addr);
+}
+
+static int cmp_live_bytes(const void *a, const void *b){
+	double x = sites[*(const int *)a].est_live_bytes, y = sites[*(const int *)b].est_live_bytes;
+	return (x < y) - (x > y);
+}
+
+static FILE *open_out(const char *tag, const char *ext){
+	char path[320];
+	snprintf(path, sizeof(path), "%s.%s.%s", out_prefix, tag, ext);
+	return fopen(path, "w");
+}
+
+static void dump_text(FILE *fp, const int *order, int n, double now, int final){
+	double tot_live = 0, tot_objs = 0, tot_alloc = 0, elapsed = now - t_start;
+	char name[256];
+	long nleak = 0;
+
+	for(int k = 0; k < n; k++){
+		tot_live += sites[order[k]].est_live_bytes;
+		tot_objs += sites[order[k]].est_live;
+		tot_alloc += sites[order[k]].est_bytes;
+	}
+	fprintf(fp, "heapprof: pid %d, %.1f s, sample every %.0f bytes, %ld sites, %ld live samples, %ld dropped\n",
+			getpid(), elapsed, rate, nsites, nlive, dropped);
+	fprintf(fp, "live %.1f KB in %.0f objects (estimated), allocated %.1f KB total, %.1f KB/s\n\n",
+			tot_live / 1024, tot_objs, tot_alloc / 1024, elapsed > 0 ? tot_alloc / 1024 / elapsed : 0);
+	fprintf(fp, "%12s %10s %12s %10s  site\n", "live_bytes", "live_objs", "alloc_KB/s", "allocs");
+	for(int k = 0; k < n && k < TOP_SITES; k++){
+		site *s = &sites[order[k]];
+		fprintf(fp, "%12.0f %10.0f %12.1f %10.0f ", s->est_live_bytes, s->est_live,
+				elapsed > 0 ? s->est_bytes / 1024 / elapsed : 0, s->est_allocs);
+		for(int f = 0; f < s->depth && f < 4; f++){
+			frame_name(s->frames[f], name, sizeof(name));
+			fprintf(fp, " %s%s", f ? "<- " : "", name);
+		}
+		fprintf(fp, "\n");
+	}
+
+	// 누수 후보: 끝날 때는 살아 있는 샘플 전부, 주기 보고에서는 leak_age 보다 오래된 것
+	fprintf(fp, "\nleak candidates (%s):\n", final ? "still allocated at exit" : "older than HEAPPROF_LEAK_AGE");
+	for(long i = 0; i < MAX_LIVE; i++){
+		live_ent *e = &live[i];
+		uintptr_t k = atomic_load_explicit(&e->ptr, memory_order_relaxed);
+		site *s;
+
+		if(k <= TOMB || (!final && now - e->t_alloc < leak_age))
+			continue;
+		s = &sites[e->site];
+		if(++nleak > 100)
+			continue;
+		fprintf(fp, "  %zu bytes at %p, age %.1f s%s\n", e->size, (void *)k, now - e->t_alloc,
+				e->weight > 1.01 ? " (sampled)" : "");
+		for(int f = 0; f < s->depth; f++){
+			frame_name(s->frames[f], name, sizeof(name));
+			fprintf(fp, "      #%d %s %p\n", f, name, s->frames[f]);
+		}
+	}
+	if(nleak > 100)
+		fprintf(fp, "  ... %ld more\n", nleak - 100);
+	if(nleak == 0)
+		fprintf(fp, "  none\n");
+}
+
+/* gperftools 힙 프로파일 (heap_v2/<rate>): 샘플 값 그대로 쓰면 pprof 가 확률 보정을 한다 */
+static void dump_pprof(FILE *fp, const int *order, int n){
+	long live_n = 0, live_b = 0, all_n = 0;
+	size_t all_b = 0;
+	FILE *maps;
+	char line[512];
+
+	for(int k = 0; k < n; k++){
+		live_n += sites[order[k]].live;
+		live_b += sites[order[k]].live_bytes;
+		all_n += sites[order[k]].allocs;
+		all_b += sites[order[k]].bytes;
+	}
+	fprintf(fp, "heap profile: %ld: %ld [ %ld: %zu] @ heap_v2/%.0f\n", live_n, live_b, all_n, all_b,
+			rate <= 1 ? 1 : rate);
+	for(int k = 0; k < n; k++){
+		site *s = &sites[order[k]];
+		fprintf(fp, "%ld: %ld [%ld: %zu] @", s->live, s->live_bytes, s->allocs, s->bytes);
+		for(int f = 0; f < s->depth; f++)
+			fprintf(fp, " %p", s->frames[f]);
+		fprintf(fp, "\n");
+	}
+	fprintf(fp, "\nMAPPED_LIBRARIES:\n");
+	if((maps = fopen("/proc/self/maps", "r")) != NULL){
+		while(fgets(line, sizeof(line), maps))
+			fputs(line, fp);
+		fclose(maps);
+	}
+}
+
+/* flamegraph.pl 입력: 바깥 프레임부터 ; 로 잇고 살아 있는 바이트 (추정) */
+static void dump_collapsed(FILE *fp, const int *order, int n){
+	char name[256];
+
+	for(int k = 0; k < n; k++){
+		site *s = &sites[order[k]];
+		if(s->est_live_bytes < 0.5)
+			continue;
+		for(int f = s->depth - 1; f >= 0; f--){
+			frame_name(s->frames[f], name, sizeof(name));
+			fprintf(fp, "%s%s", name, f ? ";" : "");
+		}
+		fprintf(fp, " %.0f\n", s->est_live_bytes);
+	}
+}
+
+static void dump(const char *tag){
+	static int order[MAX_STACKS];
+	char seq[32];
+	double now = now_sec();
+	int n = 0, final = tag != NULL;
+	FILE *fp;
+
+	if(sites == NULL)
+		return;
+	if(tag == NULL){
+		snprintf(seq, sizeof(seq), "%04d", dump_seq++);
+		tag = seq;
+	}
+	for(int i = 0; i < MAX_STACKS; i++)
+		if(sites[i].hash)
+			order[n++] = i;
+	qsort(order, n, sizeof(int), cmp_live_bytes);
+
+	if((formats & F_TEXT) && (fp = open_out(tag, "txt")) != NULL){
+		dump_text(fp, order, n, now, final);
+		fclose(fp);
+	}
+	if((formats & F_PPROF) && (fp = open_out(tag, "heap")) != NULL){
+		dump_pprof(fp, order, n);
+		fclose(fp);
+	}
+	if((formats & F_COLLAPSED) && (fp = open_out(tag, "collapsed")) != NULL){
+		dump_collapsed(fp, order, n);
+		fclose(fp);
+	}
+}
+
+__attribute__((destructor)) static void fini(void){
+	if(!inited)
+		return;
+	in_hook = 1;
+	pthread_mutex_lock(&lock);
+	dump("final");
+	pthread_mutex_unlock(&lock);
+}
+
+/* ---- 바꿔 끼우는 함수들 ---- */
+
+void *malloc(size_t size){
+	void *p = __libc_malloc(size);
+	account(p, size);
+	return p;
+}
+
+void free(void *p){
+	if(p == NULL)
+		return;
+	forget(p);
+	__libc_free(p);
+}
+
+void *calloc(size_t n, size_t size){
+	void *p = __libc_calloc(n, size);
+	account(p, n * size);
+	return p;
+}
+
+/* 크기를 바꾸면 옛 것을 해제하고 새로 할당한 것으로 센다 */
+void *realloc(void *old, size_t size){
+	void *p;
+
+	if(old && size == 0){       // glibc 에서는 free 와 같다
+		forget(old);
+		return __libc_realloc(old, size);
+	}
+	// 실패하면 old 는 그대로 살아 있으므로 성공한 뒤에만 지운다
+	if((p = __libc_realloc(old, size)) == NULL)
+		return NULL;
+	if(old)
+		forget(old);
+	account(p, size);
+	return p;
+}
+
+void *memalign(size_t align, size_t size){
+	void *p = __libc_memalign(align, size);
+	account(p, size);
+	return p;
+}
+
+void *aligned_alloc(size_t align, size_t size){
+	return memalign(align, size);
+}
+
+int posix_memalign(void **out, size_t align, size_t size){
+	void *p;
+
+	if(align < sizeof(void *) || (align & (align - 1)))
+		return EINVAL;
+	if((p = __libc_memalign(align, size)) == NULL)
+		return ENOMEM;
+	account(p, size);
+	*out = p;
+	return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef BUFPROV_H
+#define BUFPROV_H
+
+#include <stddef.h>
+
+/* 큰 버퍼를 "바로 쓸 수 있는 상태"로 준비하는 도구.
+ * mem_manage_opt.c 처럼 malloc + memset 한 줄이면 페이지 폴트를 한 스레드가 하나씩 다 받는다.
+ * 여기서는 폴트를 미리 몰아서 받거나(prefault), 여러 스레드로 나눠 받거나, huge page 로
+ * 폴트 수 자체를 줄이고, 채우기는 캐시를 거치지 않는 non-temporal store 로 할 수 있다. */
+
+enum {
+	BP_PREFAULT_NONE,           // 채우면서 폴트 (first-touch)
+	BP_PREFAULT_POPULATE,       // mmap(MAP_POPULATE): 커널이 한 번에 채움
+	BP_PREFAULT_MADVISE,        // madvise(MADV_POPULATE_WRITE) (5.14+, 없으면 touch 로 대신)
+};
+
+typedef struct {
+	int prefault;               // BP_PREFAULT_*
+	int nthreads;               // first-touch/채우기 스레드 수 (1 이하면 호출한 스레드만)
+	int huge;                   // MADV_HUGEPAGE 요청 (2 MB 정렬)
+	int nontemporal;            // 채우기를 non-temporal store 로
+	int fill;                   // 채울 바이트 값, -1 이면 폴트만 받고 내용은 0 그대로
+} bp_opts;
+
+typedef struct {
+	char *data;                 // 사용할 주소 (huge 면 2 MB 정렬)
+	size_t size;
+	void *map;                  // 해제용 실제 매핑
+	size_t map_len;
+} bp_buf;
+
+void bp_opts_default(bp_opts *o);
+
+/* size 바이트를 opts 대로 준비. 성공 0, 실패 -1 (errno 설정) */
+int bp_alloc(bp_buf *b, size_t size, const bp_opts *o);
+void bp_free(bp_buf *b);
+
+/* 이미 있는 메모리를 nthreads 로 나눠 value 로 채운다. nontemporal 이면 스트리밍 store */
+void bp_fill(void *p, size_t size, int value, int nthreads, int nontemporal);
+
+/* 페이지마다 0 을 한 번씩 써서 폴트만 받는다 (새로 받은 익명 메모리에만 쓸 것) */
+void bp_touch(void *p, size_t size, int nthreads);
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef MEMINSPECT_H
+#define MEMINSPECT_H
+
+#include <stdio.h>
+#include <sys/types.h>
+
+/* 프로세스 주소 공간과 메모리 사용량 읽기.
+ * mem_layout.c 는 스택/힙/전역/main 의 주소만 찍는다. 여기서는 /proc/<pid>/maps, smaps, smaps_rollup 을
+ * 읽어 영역마다 RSS, PSS, USS(혼자 가진 것), swap, shared/private dirty, THP 로 덮인 양을 얻고,
+ * 어떤 작업 앞뒤로 찍은 스냅숏을 비교해 어디서 늘었는지 본다.
+ * fork 로 띄운 worker 들은 부모와 페이지를 나눠 가지므로 RSS 를 더하면 부풀려진다.
+ * 여러 프로세스를 합칠 때는 PSS(나눠 가진 만큼 나눈 값)나 USS 를 더해야 한다. 값은 모두 kB. */
+
+typedef struct {
+	long size, rss, pss, uss, swap;
+	long shared_clean, shared_dirty, private_clean, private_dirty;
+	long anon, anon_huge;       // 익명 메모리, 그중 THP 로 잡힌 것
+} mi_usage;
+
+typedef struct {
+	unsigned long start, end;
+	char perms[5];
+	unsigned long offset;
+	char name[256];             // 파일 경로, [heap], [stack] 같은 이름, 없으면 [anon]
+	mi_usage u;                 // detail 로 찍었을 때만 채워진다
+} mi_region;
+
+typedef struct {
+	pid_t pid;
+	int detail;                 // 1 이면 영역마다 smaps 값이 있다
+	int n;
+	mi_region *r;
+	mi_usage total;             // smaps_rollup (없으면 영역 합)
+} mi_snapshot;
+
+/* pid 의 스냅숏 (0 이면 자기 자신). detail 이 0 이면 maps + smaps_rollup 만 읽는다 (빠름).
+ * 성공 0, 실패 -1 (errno 설정) */
+int mi_snapshot_take(mi_snapshot *s, pid_t pid, int detail);
+void mi_snapshot_free(mi_snapshot *s);
+
+/* addr 가 들어 있는 영역, 없으면 NULL */
+const mi_region *mi_lookup(const mi_snapshot *s, const void *addr);
+
+/* 합계와, 같은 이름의 영역을 묶은 표 (detail 일 때). top 개만 RSS 순으로 (0 이면 전부) */
+void mi_print(FILE *fp, const mi_snapshot *s, int top);
+
+/* 두 스냅숏의 차이: 합계, 그리고 이름별로 묶어 바뀐 것만 */
+void mi_diff(FILE *fp, const mi_snapshot *before, const mi_snapshot *after);
+
+/* pid 와 그 자손들 (/proc/<pid>/stat 의 ppid 로 찾음). 찾은 수를 돌려준다 */
+int mi_descendants(pid_t pid, pid_t *out, int max);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#include <stddef.h>
+
+/* malloc 대신 쓸 두 가지 할당기. 둘 다 큰 덩어리(chunk)를 mmap 으로 받아 잘라 쓰고,
+ * huge 를 주면 덩어리를 2 MB 정렬 + MADV_HUGEPAGE 로 받아 TLB 미스를 줄인다.
+ *   arena : 앞에서부터 잘라 주기만 하는 bump 할당기. 하나씩 해제는 없고 reset 으로 한 번에 비운다
+ *           (시뮬레이터 한 회 실행 동안 쓰는 상태처럼 수명이 같은 것들)
+ *   pool  : 크기가 같은 객체 전용. 해제한 객체는 스레드마다 가진 free list 에 쌓였다가 다시 나가고,
+ *           넘치거나 모자랄 때만 묶음(batch)으로 공용 리스트와 주고받는다 (PCB 같은 레코드) */
+
+typedef struct mp_arena mp_arena;
+typedef struct mp_pool mp_pool;
+
+/* chunk_size 단위로 받아 쓰는 arena. 실패하면 NULL */
+mp_arena *mp_arena_create(size_t chunk_size, int huge);
+void mp_arena_destroy(mp_arena *a);
+/* align 은 2 의 거듭제곱 (0 이면 16). chunk 보다 큰 요청은 그 크기의 chunk 를 따로 받는다 */
+void *mp_arena_alloc(mp_arena *a, size_t size, size_t align);
+/* 나눠 준 것을 모두 무효로 하고 처음부터 다시 쓴다. 받아 둔 chunk 는 돌려주지 않고 재사용 */
+void mp_arena_reset(mp_arena *a);
+size_t mp_arena_used(const mp_arena *a);       // 나눠 준 바이트
+size_t mp_arena_mapped(const mp_arena *a);     // mmap 으로 받은 바이트
+
+/* obj_size 짜리 객체 pool. 여러 스레드에서 불러도 된다. 실패하면 NULL */
+mp_pool *mp_pool_create(size_t obj_size, int huge);
+/* 이 pool 을 쓰던 스레드가 모두 끝난 뒤에 부를 것 */
+void mp_pool_destroy(mp_pool *p);
+void *mp_pool_alloc(mp_pool *p);
+void mp_pool_free(mp_pool *p, void *obj);
+size_t mp_pool_mapped(const mp_pool *p);
+
+#endif
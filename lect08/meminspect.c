@@ -0,0 +1,297 @@
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "meminspect.h"
+
+#define MAX_GROUPS 1024
+
+static FILE *open_proc(pid_t pid, const char *what){
+	char path[64];
+
+	if(pid)
+		snprintf(path, sizeof(path), "/proc/%d/%s", pid, what);
+	else
+		snprintf(path, sizeof(path), "/proc/self/%s", what);
+	return fopen(path, "r");
+}
+
+/* "start-end perms offset dev inode [name]" 한 줄. 영역 줄이 아니면 0 */
+static int parse_region(const char *line, mi_region *r){
+	int name_at = 0;
+
+	if(sscanf(line, "%lx-%lx %4s %lx %*s %*s %n", &r->start, &r->end, r->perms, &r->offset, &name_at) < 4
+			|| name_at == 0)
+		return 0;
+	snprintf(r->name, sizeof(r->name), "%s", line + name_at);
+	r->name[strcspn(r->name, "\n")] = '\0';
+	if(r->name[0] == '\0')
+		strcpy(r->name, "[anon]");
+	memset(&r->u, 0, sizeof(r->u));
+	return 1;
+}
+
+/* smaps/smaps_rollup 의 "Key: N kB" 한 줄을 u 에 더한다 */
+static void parse_field(const char *line, mi_usage *u){
+	static const struct { const char *key; size_t off; } keys[] = {
+		{ "Size:", offsetof(mi_usage, size) },
+		{ "Rss:", offsetof(mi_usage, rss) },
+		{ "Pss:", offsetof(mi_usage, pss) },
+		{ "Swap:", offsetof(mi_usage, swap) },
+		{ "Shared_Clean:", offsetof(mi_usage, shared_clean) },
+		{ "Shared_Dirty:", offsetof(mi_usage, shared_dirty) },
+		{ "Private_Clean:", offsetof(mi_usage, private_clean) },
+		{ "Private_Dirty:", offsetof(mi_usage, private_dirty) },
+		{ "Anonymous:", offsetof(mi_usage, anon) },
+		{ "AnonHugePages:", offsetof(mi_usage, anon_huge) },
+	};
+
+	for(size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++){
+		size_t len = strlen(keys[i].key);
+		if(strncmp(line, keys[i].key, len) == 0){
+			*(long *)((char *)u + keys[i].off) += atol(line + len);
+			u->uss = u->private_clean + u->private_dirty;
+			return;
+		}
+	}
+}
+
+static void usage_add(mi_usage *a, const mi_usage *b, int sign){
+	a->size += sign * b->size;
+	a->rss += sign * b->rss;
+	a->pss += sign * b->pss;
+	a->uss += sign * b->uss;
+	a->swap += sign * b->swap;
+	a->shared_clean += sign * b->shared_clean;
+	a->shared_dirty += sign * b->shared_dirty;
+	a->private_clean += sign * b->private_clean;
+	a->private_dirty += sign * b->private_dirty;
+	a->anon += sign * b->anon;
+	a->anon_huge += sign * b->anon_huge;
+}
+
+int mi_snapshot_take(mi_snapshot *s, pid_t pid, int detail){
+	FILE *fp = open_proc(pid, detail ? "smaps" : "maps");
+	char line[1024];
+	int cap = 256;
+	mi_region r;
+
+	memset(s, 0, sizeof(*s));
+	s->pid = pid ? pid : getpid();
+	s->detail = detail;
+	if(fp == NULL)
+		return -1;
+	if((s->r = malloc(sizeof(mi_region) * cap)) == NULL){
+		fclose(fp);
+		return -1;
+	}
+	while(fgets(line, sizeof(line), fp)){
+		if(parse_region(line, &r)){
+			if(s->n == cap){
+				mi_region *nr = realloc(s->r, sizeof(mi_region) * cap * 2);
+				if(nr == NULL){
+					fclose(fp);
+					mi_snapshot_free(s);
+					return -1;
+				}
+				s->r = nr;
+				cap *= 2;
+			}
+			s->r[s->n++] = r;
+		} else if(detail && s->n > 0){
+			parse_field(line, &s->r[s->n - 1].u);
+		}
+	}
+	fclose(fp);
+
+	// 합계는 커널이 한 번에 더해 주는 smaps_rollup 으로 (4.14+). 없으면 영역 합
+	if((fp = open_proc(pid, "smaps_rollup")) != NULL){
+		while(fgets(line, sizeof(line), fp))
+			parse_field(line, &s->total);
+		fclose(fp);
+		for(int i = 0; i < s->n; i++)
+			s->total.size += (s->r[i].end - s->r[i].start) >> 10;
+	} else {
+		for(int i = 0; i < s->n; i++)
+			usage_add(&s->total, &s->r[i].u, 1);
+	}
+	return 0;
+}
+
+void mi_snapshot_free(mi_snapshot *s){
+	free(s->r);
+	s->r = NULL;
+	s->n = 0;
+}
+
+const mi_region *mi_lookup(const mi_snapshot *s, const void *addr){
+	unsigned long a = (unsigned long)addr;
+	int lo = 0, hi = s->n - 1;
+
+	// maps 는 주소 순으로 나온다
+	while(lo <= hi){
+		int mid = (lo + hi) / 2;
+		if(a < s->r[mid].start)
+			hi = mid - 1;
+		else if(a >= s->r[mid].end)
+			lo = mid + 1;
+		else
+			return &s->r[mid];
+	}
+	return NULL;
+}
+
+int mi_descendants(pid_t pid, pid_t *out, int max){
+	int n = 0;
+
+	if(max < 1)
+		return 0;
+	out[n++] = pid;
+	// 찾은 것의 자식을 다시 찾는다: 새로 찾은 게 없을 때까지 /proc 를 훑는다
+	for(int done = 0; done < n; ){
+		DIR *dir = opendir("/proc");
+		struct dirent *de;
+		int from = done;
+
+		done = n;
+		if(dir == NULL)
+			break;
+		while((de = readdir(dir)) != NULL && n < max){
+			char path[64], buf[512], *p;
+			pid_t child = atoi(de->d_name), ppid;
+			FILE *fp;
+
+			if(child <= 0)
+				continue;
+			snprintf(path, sizeof(path), "/proc/%d/stat", child);
+			if((fp = fopen(path, "r")) == NULL)
+				continue;
+			p = fgets(buf, sizeof(buf), fp);
+			fclose(fp);
+			// comm 에 공백이나 괄호가 있을 수 있으므로 마지막 ')' 뒤부터
+			if(p == NULL || (p = strrchr(buf, ')')) == NULL || sscanf(p + 2, "%*c %d", &ppid) != 1)
+				continue;
+			for(int i = from; i < done; i++){
+				if(ppid == out[i]){
+					out[n++] = child;
+					break;
+				}
+			}
+		}
+		closedir(dir);
+	}
+	return n;
+}
+
+/* ---- 출력 ---- */
+
+typedef struct {
+	const char *name;
+	int count;
+	mi_usage u;
+} group;
+
+/* 같은 이름의 영역(라이브러리의 text/data/bss 같은)을 하나로 묶는다 */
+static int group_regions(const mi_snapshot *s, group *g, int max){
+	int n = 0;
+
+	for(int i = 0; i < s->n; i++){
+		int k;
+		for(k = 0; k < n; k++)
+			if(strcmp(g[k].name, s->r[i].name) == 0)
+				break;
+		if(k == n){
+			if(n == max)
+				k = max - 1;            // 넘치면 마지막 칸에 몰아 넣는다
+			else {
+				memset(&g[n], 0, sizeof(g[n]));
+				g[n++].name = s->r[i].name;
+			}
+		}
+		g[k].count++;
+		usage_add(&g[k].u, &s->r[i].u, 1);
+	}
+	return n;
+}
+
+static int cmp_rss(const void *a, const void *b){
+	long x = ((const group *)a)->u.rss, y = ((const group *)b)->u.rss;
+	return (x < y) - (x > y);
+}
+
+static void print_header(FILE *fp){
+	fprintf(fp, "%10s %9s %9s %9s %8s %9s %9s %6s  %s\n", "size", "rss", "pss", "uss", "swap",
+			"sh_dirty", "pv_dirty", "thp%", "mapping");
+}
+
+static void print_usage(FILE *fp, const mi_usage *u, const char *name, int count){
+	char thp[16];
+
+	if(u->anon > 0)
+		snprintf(thp, sizeof(thp), "%5.1f", 100.0 * u->anon_huge / u->anon);
+	else
+		snprintf(thp, sizeof(thp), "%5s", "-");
+	fprintf(fp, "%10ld %9ld %9ld %9ld %8ld %9ld %9ld %6s  %s", u->size, u->rss, u->pss, u->uss, u->swap,
+			u->shared_dirty, u->private_dirty, thp, name);
+	if(count > 1)
+		fprintf(fp, " (%d)", count);
+	fprintf(fp, "\n");
+}
+
+void mi_print(FILE *fp, const mi_snapshot *s, int top){
+	static group g[MAX_GROUPS];
+	int n;
+
+	fprintf(fp, "pid %d: %d regions (kB)\n", s->pid, s->n);
+	print_header(fp);
+	if(s->detail){
+		n = group_regions(s, g, MAX_GROUPS);
+		qsort(g, n, sizeof(group), cmp_rss);
+		for(int i = 0; i < n && (top <= 0 || i < top); i++)
+			print_usage(fp, &g[i].u, g[i].name, g[i].count);
+	}
+	print_usage(fp, &s->total, "total", 0);
+}
+
+void mi_diff(FILE *fp, const mi_snapshot *before, const mi_snapshot *after){
+	static group gb[MAX_GROUPS], ga[MAX_GROUPS];
+	int nb = 0, na, shown = 0;
+	mi_usage d;
+
+	fprintf(fp, "pid %d: diff (after - before, kB), regions %d -> %d\n", after->pid, before->n, after->n);
+	print_header(fp);
+	if(before->detail && after->detail){
+		nb = group_regions(before, gb, MAX_GROUPS);
+		na = group_regions(after, ga, MAX_GROUPS);
+		// 뒤 스냅숏 기준으로 짝을 찾고, 없어진 것은 음수로
+		for(int i = 0; i < na; i++){
+			d = ga[i].u;
+			for(int k = 0; k < nb; k++){
+				if(gb[k].name && strcmp(gb[k].name, ga[i].name) == 0){
+					usage_add(&d, &gb[k].u, -1);
+					gb[k].name = NULL;
+					break;
+				}
+			}
+			if(d.size || d.rss || d.pss || d.uss || d.swap){
+				print_usage(fp, &d, ga[i].name, 0);
+				shown++;
+			}
+		}
+		for(int k = 0; k < nb; k++){
+			if(gb[k].name == NULL)
+				continue;
+			memset(&d, 0, sizeof(d));
+			usage_add(&d, &gb[k].u, -1);
+			print_usage(fp, &d, gb[k].name, 0);
+			shown++;
+		}
+		if(shown == 0)
+			fprintf(fp, "  (no per-mapping change)\n");
+	}
+	d = after->total;
+	usage_add(&d, &before->total, -1);
+	print_usage(fp, &d, "total", 0);
+}
@@ -0,0 +1,158 @@
+#define _GNU_SOURCE
+#include <sys/wait.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "meminspect.h"
+
+/* meminspect 를 쓰는 명령.
+ *   pid 없이      : mem_layout.c 처럼 스택/힙/전역/static/main 주소를 찍되 어느 매핑에 있는지도 보이고,
+ *                   64 MB malloc + memset 앞뒤, fork 한 자식이 절반을 쓴 앞뒤의 차이를 보인다
+ *   pid           : 매핑별 표 (-s 면 smaps_rollup 합계만)
+ *   -i 초         : 찍고 그만큼 기다렸다 다시 찍어 차이
+ *   -c            : pid 와 자손 전체 (worker 무리): 프로세스별 합계와, RSS/PSS/USS 를 더한 값
+ * 사용법: ./meminspect [-s] [-n top(20)] [-i 초] [-c] [pid] */
+
+#define MAX_PROCS 4096
+#define DEMO_SIZE (64 * 1024 * 1024)
+
+int glob = 1;
+char *big;                      // 전역이어야 자식의 memset 이 지워지지 않는다 (바로 _exit 하므로)
+
+static void show_addr(const mi_snapshot *s, const char *what, const void *addr){
+	const mi_region *r = mi_lookup(s, addr);
+
+	printf("%-7s = %-16p %s", what, addr, r ? r->name : "?");
+	if(r)
+		printf("  [%lx-%lx %s]", r->start, r->end, r->perms);
+	printf("\n");
+}
+
+static void demo(int top){
+	static int stat = 2;
+	int stack;
+	char *heap = malloc(100);
+	mi_snapshot a, b;
+	int up[2], down[2];
+	pid_t pid;
+
+	mi_snapshot_take(&a, 0, 1);
+	show_addr(&a, "Stack", &stack);
+	show_addr(&a, "Heap", heap);
+	show_addr(&a, "Global", &glob);
+	show_addr(&a, "Static", &stat);
+	show_addr(&a, "main", (void *)demo);
+	printf("\n");
+	mi_print(stdout, &a, top);
+
+	printf("\n== malloc(64 MB) + memset ==\n");
+	big = malloc(DEMO_SIZE);
+	memset(big, 1, DEMO_SIZE);
+	mi_snapshot_take(&b, 0, 1);
+	mi_diff(stdout, &a, &b);
+	mi_snapshot_free(&a);
+
+	// 자식은 부모와 64 MB 를 나눠 갖다가, 절반을 쓰면 그만큼 자기 것(USS)이 된다
+	printf("\n== fork, child writes half (parent view, then child view) ==\n");
+	pipe(up);
+	pipe(down);
+	fflush(stdout);
+	if((pid = fork()) == 0){
+		mi_snapshot c0, c1;
+		char ok;
+		mi_snapshot_take(&c0, 0, 1);
+		memset(big, 2, DEMO_SIZE / 2);
+		mi_snapshot_take(&c1, 0, 1);
+		write(up[1], "x", 1);
+		read(down[0], &ok, 1);      // 부모가 찍을 때까지 살아 있는다
+		mi_diff(stdout, &c0, &c1);
+		fflush(stdout);
+		_exit(0);
+	}
+	{
+		char ok;
+		read(up[0], &ok, 1);
+		mi_snapshot_take(&a, 0, 1);
+		mi_diff(stdout, &b, &a);
+		fflush(stdout);
+		write(down[1], "x", 1);
+	}
+	waitpid(pid, NULL, 0);
+	mi_snapshot_free(&a);
+	mi_snapshot_free(&b);
+	free(big);
+	free(heap);
+}
+
+/* 무리 전체: 프로세스마다 한 줄, 끝에 합계 */
+static void fleet(pid_t root){
+	static pid_t pids[MAX_PROCS];
+	int n = mi_descendants(root, pids, MAX_PROCS);
+	long rss = 0, pss = 0, uss = 0, swap = 0;
+
+	printf("%8s %9s %9s %9s %8s\n", "pid", "rss", "pss", "uss", "swap");
+	for(int i = 0; i < n; i++){
+		mi_snapshot s;
+		if(mi_snapshot_take(&s, pids[i], 0) == -1)
+			continue;
+		printf("%8d %9ld %9ld %9ld %8ld\n", pids[i], s.total.rss, s.total.pss, s.total.uss, s.total.swap);
+		rss += s.total.rss;
+		pss += s.total.pss;
+		uss += s.total.uss;
+		swap += s.total.swap;
+		mi_snapshot_free(&s);
+	}
+	// RSS 합은 나눠 가진 페이지를 여러 번 센다. 실제 사용량에 가까운 것은 PSS 합
+	printf("%8s %9ld %9ld %9ld %8ld  (%d processes, kB)\n", "sum", rss, pss, uss, swap, n);
+}
+
+int main(int argc, char *argv[]){
+	int detail = 1, top = 20, children = 0, interval = 0, opt;
+	pid_t pid = 0;
+	mi_snapshot a, b;
+
+	while((opt = getopt(argc, argv, "sn:i:c")) != -1){
+		if(opt == 's') detail = 0;
+		else if(opt == 'n') top = atoi(optarg);
+		else if(opt == 'i') interval = atoi(optarg);
+		else if(opt == 'c') children = 1;
+		else {
+			fprintf(stderr, "Usage : %s [-s] [-n top] [-i seconds] [-c] [pid]\n", argv[0]);
+			exit(1);
+		}
+	}
+	if(optind < argc)
+		pid = atoi(argv[optind]);
+
+	if(pid == 0 && !children && !interval){
+		demo(top);
+		return 0;
+	}
+	if(children){
+		fleet(pid ? pid : getpid());
+		if(interval > 0){
+			sleep(interval);
+			printf("\nafter %d s\n", interval);
+			fleet(pid ? pid : getpid());
+		}
+		return 0;
+	}
+	if(mi_snapshot_take(&a, pid, detail) == -1){
+		perror("meminspect");
+		exit(1);
+	}
+	if(interval > 0){
+		sleep(interval);
+		if(mi_snapshot_take(&b, pid, detail) == -1){
+			perror("meminspect");
+			exit(1);
+		}
+		mi_diff(stdout, &a, &b);
+		mi_snapshot_free(&b);
+	} else {
+		mi_print(stdout, &a, top);
+	}
+	mi_snapshot_free(&a);
+	return 0;
+}
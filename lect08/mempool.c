@@ -0,0 +1,303 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "mempool.h"
+
+#define PAGE_SIZE 4096
+#define HUGE_SIZE (2 * 1024 * 1024)
+#define POOL_SLAB (1024 * 1024)     // pool 이 한 번에 받는 크기 (huge 면 2 MB)
+#define POOL_BATCH 64               // 스레드 free list 와 공용 리스트가 주고받는 개수
+#define POOL_MIN_OBJS 8             // 큰 객체라도 slab 하나에 이만큼은 들어가도록
+
+/* ---- 덩어리 받기 ---- */
+
+typedef struct chunk {
+	struct chunk *next;
+	size_t len;                 // 쓸 수 있는 길이 (헤더 포함)
+	void *map;                  // 해제용 실제 매핑
+	size_t map_len;
+} chunk;
+
+/* len 바이트짜리 덩어리. 앞부분에 chunk 헤더가 들어간다 */
+static chunk *chunk_get(size_t len, int huge){
+	size_t align = huge ? HUGE_SIZE : PAGE_SIZE;
+	size_t map_len;
+	char *map, *data;
+	chunk *c;
+
+	len = (len + align - 1) & ~(align - 1);
+	map_len = huge ? len + HUGE_SIZE : len;
+	map = mmap(NULL, map_len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if(map == MAP_FAILED)
+		return NULL;
+	data = map;
+	if(huge){
+		data = (char *)(((uintptr_t)map + HUGE_SIZE - 1) & ~(uintptr_t)(HUGE_SIZE - 1));
+		madvise(data, len, MADV_HUGEPAGE);
+	}
+	c = (chunk *)data;
+	c->next = NULL;
+	c->len = len;
+	c->map = map;
+	c->map_len = map_len;
+	return c;
+}
+
+static void chunk_put_all(chunk *c){
+	while(c){
+		chunk *next = c->next;
+		munmap(c->map, c->map_len);
+		c = next;
+	}
+}
+
+/* ---- arena ---- */
+
+struct mp_arena {
+	chunk *head;                // 받은 chunk 들 (처음 받은 것부터)
+	chunk *cur;                 // 지금 잘라 쓰는 chunk
+	size_t off;                 // cur 안의 다음 위치
+	size_t chunk_size;
+	size_t used, mapped;
+	int huge;
+};
+
+mp_arena *mp_arena_create(size_t chunk_size, int huge){
+	mp_arena *a = malloc(sizeof(*a));
+
+	if(a == NULL)
+		return NULL;
+	a->chunk_size = chunk_size < PAGE_SIZE ? PAGE_SIZE : chunk_size;
+	a->huge = huge;
+	a->head = a->cur = chunk_get(a->chunk_size, huge);
+	if(a->head == NULL){
+		free(a);
+		return NULL;
+	}
+	a->off = sizeof(chunk);
+	a->used = 0;
+	a->mapped = a->head->len;
+	return a;
+}
+
+void mp_arena_destroy(mp_arena *a){
+	chunk_put_all(a->head);
+	free(a);
+}
+
+void *mp_arena_alloc(mp_arena *a, size_t size, size_t align){
+	uintptr_t base, p;
+
+	if(align == 0)
+		align = 16;
+	for(;;){
+		base = (uintptr_t)a->cur;
+		p = (base + a->off + align - 1) & ~(uintptr_t)(align - 1);
+		if(p + size <= base + a->cur->len)
+			break;
+		// reset 뒤라면 다음 chunk 가 이미 있다. 없거나 모자라면 새로 받아 뒤에 붙인다
+		if(a->cur->next == NULL || a->cur->next->len < sizeof(chunk) + size + align){
+			size_t want = sizeof(chunk) + size + align;
+			chunk *c = chunk_get(want > a->chunk_size ? want : a->chunk_size, a->huge);
+			if(c == NULL)
+				return NULL;
+			c->next = a->cur->next;
+			a->cur->next = c;
+			a->mapped += c->len;
+		}
+		a->cur = a->cur->next;
+		a->off = sizeof(chunk);
+	}
+	a->off = p + size - base;
+	a->used += size;
+	return (void *)p;
+}
+
+void mp_arena_reset(mp_arena *a){
+	a->cur = a->head;
+	a->off = sizeof(chunk);
+	a->used = 0;
+}
+
+size_t mp_arena_used(const mp_arena *a){
+	return a->used;
+}
+
+size_t mp_arena_mapped(const mp_arena *a){
+	return a->mapped;
+}
+
+/* ---- pool ---- */
+
+typedef struct free_obj {
+	struct free_obj *next;
+} free_obj;
+
+/* 스레드 하나가 이 pool 에 대해 가진 free list */
+typedef struct tcache {
+	free_obj *head;
+	int count;
+	mp_pool *pool;
+	struct tcache *next;        // pool 이 가진 모든 tcache (destroy 때 해제)
+} tcache;
+
+struct mp_pool {
+	pthread_mutex_t lock;       // 아래 공용 상태를 보호
+	free_obj *free;             // 공용 free list
+	chunk *slabs;
+	char *bump, *bump_end;      // 지금 잘라 쓰는 slab 의 남은 부분
+	size_t mapped;
+	tcache *caches;
+	size_t obj_size;
+	size_t slab_size;           // slab 하나의 크기 (큰 객체면 POOL_SLAB 보다 크다)
+	size_t slab_head;           // slab 앞의 chunk 헤더 자리 (obj_size 의 배수)
+	int batch;                  // 주고받는 개수: POOL_BATCH 와 slab 하나에 드는 개수 중 작은 쪽
+	int huge;
+	pthread_key_t key;
+};
+
+/* 공용 리스트에서 최대 p->batch 개를 tc 로 가져온다. 없으면 slab 에서 잘라 온다 */
+static int refill(mp_pool *p, tcache *tc){
+	pthread_mutex_lock(&p->lock);
+	while(tc->count < p->batch){
+		free_obj *o = p->free;
+		if(o){
+			p->free = o->next;
+		} else {
+			if(p->bump + p->obj_size > p->bump_end){
+				chunk *c = chunk_get(p->slab_size, p->huge);
+				if(c == NULL)
+					break;
+				c->next = p->slabs;
+				p->slabs = c;
+				p->mapped += c->len;
+				p->bump = (char *)c + p->slab_head;
+				p->bump_end = (char *)c + c->len;
+			}
+			o = (free_obj *)p->bump;
+			p->bump += p->obj_size;
+		}
+		o->next = tc->head;
+		tc->head = o;
+		tc->count++;
+	}
+	pthread_mutex_unlock(&p->lock);
+	return tc->count > 0;
+}
+
+/* tc 에서 n 개를 공용 리스트로 돌려준다 */
+static void drain(mp_pool *p, tcache *tc, int n){
+	free_obj *first = tc->head, *last = first;
+	int k = 1;
+
+	if(n <= 0 || first == NULL)
+		return;
+	for(; k < n && last->next; k++)
+		last = last->next;
+	tc->head = last->next;
+	tc->count -= k;
+	pthread_mutex_lock(&p->lock);
+	last->next = p->free;
+	p->free = first;
+	pthread_mutex_unlock(&p->lock);
+}
+
+/* 스레드가 끝날 때: 가진 것을 모두 돌려준다. tcache 자체는 destroy 때 해제 */
+static void tcache_exit(void *arg){
+	tcache *tc = arg;
+	drain(tc->pool, tc, tc->count);
+}
+
+static tcache *get_tcache(mp_pool *p){
+	tcache *tc = pthread_getspecific(p->key);
+
+	if(tc)
+		return tc;
+	if((tc = calloc(1, sizeof(*tc))) == NULL)
+		return NULL;
+	tc->pool = p;
+	pthread_mutex_lock(&p->lock);
+	tc->next = p->caches;
+	p->caches = tc;
+	pthread_mutex_unlock(&p->lock);
+	pthread_setspecific(p->key, tc);
+	return tc;
+}
+
+mp_pool *mp_pool_create(size_t obj_size, int huge){
+	mp_pool *p = calloc(1, sizeof(*p));
+
+	if(p == NULL)
+		return NULL;
+	// slab 크기를 계산하다 넘치지 않도록
+	if(obj_size > (SIZE_MAX - HUGE_SIZE) / (POOL_MIN_OBJS + 2)){
+		free(p);
+		return NULL;
+	}
+	// free list 포인터가 들어가고 정렬이 맞도록
+	if(obj_size < sizeof(free_obj))
+		obj_size = sizeof(free_obj);
+	p->obj_size = (obj_size + 15) & ~(size_t)15;
+	p->slab_head = (sizeof(chunk) + p->obj_size - 1) / p->obj_size * p->obj_size;
+	p->slab_size = huge ? HUGE_SIZE : POOL_SLAB;
+	if(p->slab_size < p->slab_head + POOL_MIN_OBJS * p->obj_size)
+		p->slab_size = p->slab_head + POOL_MIN_OBJS * p->obj_size;
+	p->batch = (p->slab_size - p->slab_head) / p->obj_size;
+	if(p->batch > POOL_BATCH)
+		p->batch = POOL_BATCH;
+	p->huge = huge;
+	pthread_mutex_init(&p->lock, NULL);
+	if(pthread_key_create(&p->key, tcache_exit) != 0){
+		free(p);
+		return NULL;
+	}
+	return p;
+}
+
+void mp_pool_destroy(mp_pool *p){
+	pthread_key_delete(p->key);
+	while(p->caches){
+		tcache *next = p->caches->next;
+		free(p->caches);
+		p->caches = next;
+	}
+	chunk_put_all(p->slabs);
+	pthread_mutex_destroy(&p->lock);
+	free(p);
+}
+
+void *mp_pool_alloc(mp_pool *p){
+	tcache *tc = get_tcache(p);
+	free_obj *o;
+
+	if(tc == NULL || (tc->head == NULL && !refill(p, tc)))
+		return NULL;
+	o = tc->head;
+	tc->head = o->next;
+	tc->count--;
+	return o;
+}
+
+void mp_pool_free(mp_pool *p, void *obj){
+	tcache *tc = get_tcache(p);
+	free_obj *o = obj;
+
+	if(tc == NULL){
+		pthread_mutex_lock(&p->lock);
+		o->next = p->free;
+		p->free = o;
+		pthread_mutex_unlock(&p->lock);
+		return;
+	}
+	o->next = tc->head;
+	tc->head = o;
+	// 한 스레드가 계속 해제만 하면(생산자-소비자) 반을 공용으로 넘긴다
+	if(++tc->count >= 2 * p->batch)
+		drain(p, tc, p->batch);
+}
+
+size_t mp_pool_mapped(const mp_pool *p){
+	return p->mapped;
+}